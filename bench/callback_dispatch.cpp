@@ -0,0 +1,181 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+// Measure the cost of finding the easy wrapper from a callback.
+//
+// Usage: callback_dispatch [CALLS]
+//
+// "lookup" is how the callback helpers used to work: the *DATA option held the CURL*
+// handle, and every call asked libcurl for the wrapper with CURLINFO_PRIVATE. "direct"
+// is how they work now: the *DATA option points to the wrapper.
+//
+// The first part calls both versions in a loop. The second part downloads a file:// URL
+// in 1 KiB writes, once through easy::set_write_function(), and once through a write
+// callback that does the CURLINFO_PRIVATE lookup.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <curlxx/curl.hpp>
+
+
+namespace {
+
+    using write_function_t = std::move_only_function<std::size_t (std::span<const char>)>;
+
+    // Stands for the callback stored in the wrapper.
+    write_function_t write_func;
+    std::size_t received = 0;
+
+
+    std::size_t
+    lookup_write(char* buffer,
+                 std::size_t size,
+                 std::size_t nmemb,
+                 void* handle)
+    {
+        auto ez = curl::easy::get_wrapper(static_cast<CURL*>(handle));
+        if (!ez)
+            return CURL_WRITEFUNC_ERROR;
+        return write_func({buffer, size * nmemb});
+    }
+
+
+    std::size_t
+    direct_write(char* buffer,
+                 std::size_t size,
+                 std::size_t nmemb,
+                 void* wrapper)
+    {
+        auto ez = static_cast<curl::easy*>(wrapper);
+        if (!ez)
+            return CURL_WRITEFUNC_ERROR;
+        return write_func({buffer, size * nmemb});
+    }
+
+
+    template<typename Func>
+    double
+    seconds(Func&& func)
+    {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+            .count();
+    }
+
+
+    void
+    print(const char* name,
+          double secs,
+          unsigned long calls)
+    {
+        std::cout << name << ": " << secs * 1e9 / calls << " ns per call\n";
+    }
+
+
+    // Call the helpers directly, as libcurl would.
+    void
+    bench_calls(unsigned long calls)
+    {
+        curl::easy ez;
+        char byte = 0;
+        // Keep the compiler from dropping the calls.
+        void* volatile handle = ez.data();
+        void* volatile wrapper = &ez;
+
+        print("lookup, helper only",
+              seconds([&]
+              {
+                  for (unsigned long i = 0; i < calls; ++i)
+                      lookup_write(&byte, 1, 1, handle);
+              }),
+              calls);
+        print("direct, helper only",
+              seconds([&]
+              {
+                  for (unsigned long i = 0; i < calls; ++i)
+                      direct_write(&byte, 1, 1, wrapper);
+              }),
+              calls);
+    }
+
+
+    // Download a local file, with libcurl calling the write callback for every 1 KiB.
+    void
+    bench_transfer(unsigned long calls)
+    {
+        auto path = std::filesystem::temp_directory_path() / "curlxx-callback-dispatch.bin";
+        {
+            std::vector<char> block(1024);
+            std::FILE* f = std::fopen(path.c_str(), "wb");
+            if (!f) {
+                std::cerr << "can't create " << path << '\n';
+                return;
+            }
+            for (unsigned long i = 0; i < calls; ++i)
+                std::fwrite(block.data(), 1, block.size(), f);
+            std::fclose(f);
+        }
+
+        curl::easy ez;
+        ez.set_url("file://" + path.string());
+        ez.set_buffer_size(1024);
+
+        received = 0;
+        ez.set_write_function([](std::span<const char> data)
+                              {
+                                  received += data.size();
+                                  return data.size();
+                              });
+        // Warm up the file cache.
+        ez.perform();
+        received = 0;
+        double secs = seconds([&] { ez.perform(); });
+        print("direct, file:// transfer", secs, received / 1024);
+
+        // Same callback (write_func), but found through CURLINFO_PRIVATE.
+        ez.unset_write_function();
+        curl_easy_setopt(ez.data(), CURLOPT_WRITEDATA, ez.data());
+        curl_easy_setopt(ez.data(), CURLOPT_WRITEFUNCTION, &lookup_write);
+        received = 0;
+        secs = seconds([&] { ez.perform(); });
+        print("lookup, file:// transfer", secs, received / 1024);
+        ez.unset_write_function();
+
+        std::filesystem::remove(path);
+    }
+
+} // namespace
+
+
+int
+main(int argc, char* argv[])
+{
+    unsigned long calls = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    if (!calls) {
+        std::cerr << "Usage: " << argv[0] << " [CALLS]\n";
+        return EXIT_FAILURE;
+    }
+
+    curl::global::init global;
+
+    write_func = [](std::span<const char> data)
+    {
+        received += data.size();
+        return data.size();
+    };
+    bench_calls(calls);
+    bench_transfer(calls / 10);
+}
@@ -0,0 +1,159 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+// Compare how often a perform() loop and an epoll_loop wake up to run the same
+// transfers.
+//
+// Usage: epoll_wakeups URL [TRANSFERS]
+//
+// All transfers are started at once, against a local HTTP server, e.g.:
+//     bench/epoll_wakeups http://127.0.0.1:8000/some-large-file 100
+//
+// The server needs a listen backlog larger than TRANSFERS (python's http.server uses 5),
+// otherwise dropped connection attempts are retried after a second or more, and the
+// timings measure that instead.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <list>
+#include <string>
+
+#include <curlxx/curl.hpp>
+
+
+namespace {
+
+    struct result {
+        std::uint64_t wakeups = 0;
+        unsigned failed = 0;
+        double cpu_seconds = 0;
+        double wall_seconds = 0;
+    };
+
+
+    void
+    add_transfers(curl::multi& m,
+                  std::list<curl::easy>& transfers,
+                  const std::string& url,
+                  unsigned count)
+    {
+        for (unsigned i = 0; i < count; ++i) {
+            auto& ez = transfers.emplace_back();
+            ez.set_url(url);
+            ez.set_write_function([](std::span<const char> data)
+                                  {
+                                      return data.size();
+                                  });
+            m.add(ez);
+        }
+    }
+
+
+    unsigned
+    count_failed(curl::multi& m)
+    {
+        unsigned failed = 0;
+        for (auto& msg : m.get_done())
+            if (msg.result != CURLE_OK)
+                ++failed;
+        return failed;
+    }
+
+
+    template<typename Func>
+    result
+    measure(Func&& func)
+    {
+        auto wall_start = std::chrono::steady_clock::now();
+        auto cpu_start = std::clock();
+        result r = func();
+        r.cpu_seconds = double(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+        r.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                                       - wall_start).count();
+        return r;
+    }
+
+
+    result
+    run_perform_loop(const std::string& url,
+                     unsigned count)
+    {
+        curl::multi m;
+        std::list<curl::easy> transfers;
+        add_transfers(m, transfers, url, count);
+        return measure([&]
+        {
+            result r;
+            while (m.perform()) {
+                m.poll(std::chrono::seconds{1});
+                ++r.wakeups;
+            }
+            r.failed = count_failed(m);
+            return r;
+        });
+    }
+
+
+    result
+    run_epoll_loop(const std::string& url,
+                   unsigned count)
+    {
+        curl::multi m;
+        std::list<curl::easy> transfers;
+        curl::epoll_loop loop{m};
+        add_transfers(m, transfers, url, count);
+        return measure([&]
+        {
+            result r;
+            loop.run();
+            r.wakeups = loop.get_wakeups();
+            r.failed = count_failed(m);
+            return r;
+        });
+    }
+
+
+    void
+    print(const char* name,
+          const result& r,
+          unsigned count)
+    {
+        std::cout << name << ": "
+                  << r.wakeups << " wakeups, "
+                  << double(r.wakeups) / count << " per transfer, "
+                  << r.cpu_seconds << " s CPU, "
+                  << r.wall_seconds << " s wall";
+        if (r.failed)
+            std::cout << ", " << r.failed << " failed";
+        std::cout << '\n';
+    }
+
+} // namespace
+
+
+int
+main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " URL [TRANSFERS]\n";
+        return EXIT_FAILURE;
+    }
+    std::string url = argv[1];
+    unsigned count = argc > 2 ? std::stoul(argv[2]) : 100;
+    if (!count) {
+        std::cerr << "TRANSFERS must be positive\n";
+        return EXIT_FAILURE;
+    }
+
+    curl::global::init global;
+
+    print("perform() loop", run_perform_loop(url, count), count);
+    print("epoll_loop    ", run_epoll_loop(url, count), count);
+}
@@ -0,0 +1,132 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef CURLXX_ARENA_SLIST_HPP
+#define CURLXX_ARENA_SLIST_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <ranges>
+#include <string_view>
+
+#include <curl/curl.h>
+
+#include "slist.hpp"
+
+
+namespace curl {
+
+    // A read-only curl_slist, where all the nodes and strings live in a single
+    // allocation. Building one costs one allocation, instead of two per entry like slist.
+    // It can be used anywhere libcurl takes a curl_slist* it doesn't modify (headers,
+    // connect_to, resolve, etc).
+    class arena_slist {
+
+        std::unique_ptr<std::byte[]> storage;
+        curl_slist* head = nullptr;
+        curl_slist* tail = nullptr;
+        char* next_char = nullptr;
+        std::size_t count = 0;
+
+
+        // Allocate the storage for num_entries strings, with total_chars characters
+        // (not counting the null terminators).
+        void
+        allocate(std::size_t num_entries,
+                 std::size_t total_chars);
+
+        // Store one string. Must be called no more times than allocated for.
+        void
+        push(std::string_view str)
+            noexcept;
+
+    public:
+
+        using value_type = slist::value_type;
+        using size_type = slist::size_type;
+        using const_iterator = slist::const_iterator;
+        using iterator = const_iterator;
+
+
+        arena_slist()
+            noexcept = default;
+
+        arena_slist(std::initializer_list<std::string_view> values);
+
+        template<std::ranges::forward_range R>
+        requires std::convertible_to<std::ranges::range_reference_t<R>, std::string_view>
+        explicit
+        arena_slist(R&& values)
+        {
+            std::size_t num_entries = 0;
+            std::size_t total_chars = 0;
+            for (std::string_view str : values) {
+                ++num_entries;
+                total_chars += str.size();
+            }
+            allocate(num_entries, total_chars);
+            for (std::string_view str : values)
+                push(str);
+        }
+
+        arena_slist(const arena_slist& other);
+
+        arena_slist(arena_slist&& other)
+            noexcept;
+
+
+        arena_slist&
+        operator =(const arena_slist& other);
+
+        arena_slist&
+        operator =(arena_slist&& other)
+            noexcept;
+
+
+        [[nodiscard]]
+        const curl_slist*
+        data()
+            const noexcept;
+
+        // Note: libcurl takes a non-const pointer, but doesn't modify the list.
+        [[nodiscard]]
+        curl_slist*
+        data()
+            noexcept;
+
+
+        const_iterator
+        begin()
+            const noexcept;
+
+        const_iterator
+        end()
+            const noexcept;
+
+
+        [[nodiscard]]
+        size_type
+        size()
+            const noexcept;
+
+        [[nodiscard]]
+        bool
+        empty()
+            const noexcept;
+
+
+        explicit
+        operator bool()
+            const noexcept;
+
+    }; // class arena_slist
+
+} // namespace curl
+
+#endif
@@ -0,0 +1,214 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef CURLXX_COROUTINE_HPP
+#define CURLXX_COROUTINE_HPP
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <expected>
+#include <unordered_map>
+
+#include <curl/curl.h>
+
+#include "error.hpp"
+#include "multi.hpp"
+
+
+namespace curl {
+
+    class easy;
+
+
+    // Fire-and-forget coroutine type, that starts running immediately.
+    // Note: an exception escaping the coroutine terminates the program.
+    struct task {
+
+        struct promise_type {
+
+            task
+            get_return_object()
+                noexcept
+            {
+                return {};
+            }
+
+            std::suspend_never
+            initial_suspend()
+                noexcept
+            {
+                return {};
+            }
+
+            std::suspend_never
+            final_suspend()
+                noexcept
+            {
+                return {};
+            }
+
+            void
+            return_void()
+                noexcept
+            {}
+
+            void
+            unhandled_exception()
+                noexcept
+            {
+                std::terminate();
+            }
+
+        }; // struct promise_type
+
+    }; // struct task
+
+
+    // Awaitable for a single transfer.
+    // It suspends the coroutine until complete() is called; whoever drives the multi
+    // handle is responsible for that, usually when the handle shows up in
+    // multi::get_done().
+    class transfer {
+
+    public:
+
+        using register_function_t = std::expected<void, error> (void* context,
+                                                                transfer& t);
+
+    private:
+
+        easy* ez;
+        void* context;
+        register_function_t* on_suspend;
+        std::coroutine_handle<> waiter;
+        std::expected<void, error> result;
+
+    public:
+
+        // The on_suspend function is called when the coroutine suspends; it must arrange
+        // for complete() to be called later. If it fails, the coroutine is not suspended.
+        transfer(easy& ez,
+                 void* context,
+                 register_function_t* on_suspend)
+            noexcept;
+
+        // This object can't be moved, its address is used while the coroutine waits.
+        transfer(const transfer&) = delete;
+
+
+        [[nodiscard]]
+        easy&
+        get_easy()
+            const noexcept;
+
+
+        // Store the result and resume the coroutine.
+        void
+        complete(CURLcode code)
+            noexcept;
+
+        // Destroy the waiting coroutine, without resuming it.
+        void
+        abandon()
+            noexcept;
+
+
+        bool
+        await_ready()
+            const noexcept;
+
+        bool
+        await_suspend(std::coroutine_handle<> h)
+            noexcept;
+
+        std::expected<void, error>
+        await_resume()
+            noexcept;
+
+    }; // class transfer
+
+
+    // Minimal single-threaded scheduler: it owns a multi handle, and resumes the
+    // coroutines waiting on fetch() as their transfers complete.
+    //
+    // Example:
+    //
+    //     curl::task get(curl::client& c, std::string url)
+    //     {
+    //         curl::easy ez;
+    //         ez.set_url(url);
+    //         auto result = co_await c.fetch(ez);
+    //         ...
+    //     }
+    //
+    //     curl::client c;
+    //     get(c, "https://example.com");
+    //     c.run();
+    class client {
+
+        multi multi_handle;
+        std::unordered_map<easy*, transfer*> pending;
+
+
+        static
+        std::expected<void, error>
+        start(void* context,
+              transfer& t)
+            noexcept;
+
+        void
+        dispatch_done();
+
+    public:
+
+        client();
+
+        // This object can't be moved, the pending transfers refer to it.
+        client(const client&) = delete;
+
+        // Note: coroutines still waiting for a transfer are destroyed.
+        ~client()
+            noexcept;
+
+
+        [[nodiscard]]
+        multi&
+        get_multi()
+            noexcept;
+
+
+        // The easy handle must stay alive until the co_await expression completes.
+        [[nodiscard]]
+        transfer
+        fetch(easy& ez)
+            noexcept;
+
+
+        // Perform transfers, wait up to timeout for activity, and resume the coroutines
+        // whose transfers are done.
+        // Returns the number of transfers still pending.
+        std::size_t
+        run_once(std::chrono::milliseconds timeout = std::chrono::milliseconds{1000});
+
+
+        // Call run_once() until there are no more pending transfers.
+        void
+        run();
+
+
+        [[nodiscard]]
+        std::size_t
+        get_pending()
+            const noexcept;
+
+    }; // class client
+
+} // namespace curl
+
+#endif
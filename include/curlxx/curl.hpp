@@ -8,14 +8,30 @@
 #ifndef CURLXX_CURL_HPP
 #define CURLXX_CURL_HPP
 
+#include "arena_slist.hpp"
+#include "coroutine.hpp"
 #include "easy.hpp"
+#include "easy_pool.hpp"
 #include "error.hpp"
 #include "escape.hpp"
+#include "features.hpp"
 #include "header.hpp"
+#include "header_parser.hpp"
 #include "global.hpp"
+#include "metrics.hpp"
 #include "mime.hpp"
 #include "multi.hpp"
+#include "multi_pool.hpp"
+#include "request_template.hpp"
+#include "share.hpp"
+#include "sink.hpp"
+#include "source.hpp"
 #include "slist.hpp"
+#include "trace.hpp"
 #include "url.hpp"
 
+#if CURLXX_HAVE_EPOLL_LOOP
+#include "epoll_loop.hpp"
+#endif
+
 #endif
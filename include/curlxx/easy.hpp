@@ -15,6 +15,8 @@
 #include <expected>
 #include <filesystem>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
@@ -24,17 +26,23 @@
 
 #include <curl/curl.h>
 
+#include "arena_slist.hpp"
 #include "basic_wrapper.hpp"
 #include "concepts.hpp"
 #include "error.hpp"
 #include "header.hpp"
 #include "mime.hpp"
+#include "share.hpp"
 #include "slist.hpp"
 #include "url.hpp"
 
 
 namespace curl {
 
+    struct multi;
+    class tracer;
+
+
     class easy : public detail::basic_wrapper<CURL*> {
 
     public:
@@ -68,6 +76,10 @@ namespace curl {
 
         using read_callback_signature = std::size_t (std::span<char>);
 
+        // Must return one of CURL_SEEKFUNC_OK, CURL_SEEKFUNC_FAIL, CURL_SEEKFUNC_CANTSEEK.
+        using seek_callback_signature = int (curl_off_t offset,
+                                             int origin);
+
         using write_callback_signature = std::size_t (std::span<const char>);
 
 
@@ -78,25 +90,60 @@ namespace curl {
         using opensocket_function_t  = std::move_only_function<opensocket_callback_signature>;
         using progress_function_t    = std::move_only_function<progress_callback_signature>;
         using read_function_t        = std::move_only_function<read_callback_signature>;
+        using seek_function_t        = std::move_only_function<seek_callback_signature>;
         using write_function_t       = std::move_only_function<write_callback_signature>;
 
 
+        // Body collected by set_write_to_memory().
+        struct memory_body_type {
+            std::string data;
+            std::size_t max_reserve = 0;
+            curl_off_t  expected = -1; // from the Content-Length header
+            bool        enabled = false;
+            bool        reserved = false;
+        };
+
+
         struct extra_state_type {
             std::vector<char> error_buffer;
 
-            closesocket_function_t closesocket_func;
-            debug_function_t       debug_func;
-            fnmatch_function_t     fnmatch_func;
-            header_function_t      header_func;
-            opensocket_function_t  opensocket_func;
-            progress_function_t    progress_func;
-            read_function_t        read_func;
-            write_function_t       write_func;
+            // The callbacks are shared between copies of a handle.
+            std::shared_ptr<closesocket_function_t> closesocket_func;
+            std::shared_ptr<debug_function_t>       debug_func;
+            std::shared_ptr<fnmatch_function_t>     fnmatch_func;
+            std::shared_ptr<header_function_t>      header_func;
+            std::shared_ptr<opensocket_function_t>  opensocket_func;
+            std::shared_ptr<progress_function_t>    progress_func;
+            std::shared_ptr<read_function_t>        read_func;
+            std::shared_ptr<seek_function_t>        seek_func;
+            std::shared_ptr<write_function_t>       write_func;
+
+            memory_body_type memory_body;
+            // The sink set by set_write_sink(); the write helper knows its type.
+            void* write_sink = nullptr;
+            // Whether the sink's start() was called for the current transfer.
+            bool write_sink_started = false;
+            // The callback was set through set_*_function<Func>(obj); the header one must
+            // also be left alone by the memory body.
+            bool header_bound_statically = false;
+            bool progress_bound_statically = false;
+            bool read_bound_statically = false;
+            bool seek_bound_statically = false;
+            bool write_bound_statically = false;
 
             slist    http_headers_list;
             slist    connect_to_list;
+            // Lists owned by someone else (a shared slist, an arena_slist); the pointer
+            // shares the ownership of the object holding the list.
+            std::shared_ptr<const curl_slist> shared_http_headers;
+            std::shared_ptr<const curl_slist> shared_connect_to;
             url      url_obj{nullptr};
             std::any private_data;
+
+            std::shared_ptr<tracer> trace_sink;
+            // Id of the current transfer in the tracer; zero if it's not sampled.
+            std::uint64_t trace_transfer = 0;
+            bool trace_first_byte = false;
         };
 
         // combine base_type::state_type and extra_state_type
@@ -117,6 +164,11 @@ namespace curl {
         easy(CURL* handle);
 
         /// Copy constructor.
+        /// The copy gets its own copy of the header lists and URL object, and shares the
+        /// callbacks with other: the same callable (or the same object, for the ones bound
+        /// statically, and the sinks and sources) is called by both handles. A callable
+        /// with state sees the transfers of every copy, so if the copies run on different
+        /// threads, it must be safe to call concurrently.
         easy(const easy& other);
 
         /// Move constructor
@@ -526,6 +578,13 @@ namespace curl {
         try_set_connect_to(slist hosts)
             noexcept;
 
+        void
+        set_connect_to(arena_slist hosts);
+
+        std::expected<void, error>
+        try_set_connect_to(arena_slist hosts)
+            noexcept;
+
 
         // CURLOPT_COOKIE
         // Cookie(s) to send.
@@ -714,6 +773,26 @@ namespace curl {
             noexcept;
 
 
+        // Record the events of each transfer (name resolving, connection, TLS handshake,
+        // headers, first byte and completion) in a tracer, through the debug callback; the
+        // connection and TLS events come from the timing info, when the transfer is done.
+        // Note: this takes over CURLOPT_VERBOSE, enabling it only for the sampled
+        // transfers (or when a debug function is also set), and
+        // CURLOPT_RESOLVER_START_FUNCTION.
+        // Note: completion is only seen by perform() and multi::next_done().
+
+        void
+        set_tracer(std::shared_ptr<tracer> t);
+
+        std::expected<void, error>
+        try_set_tracer(std::shared_ptr<tracer> t)
+            noexcept;
+
+        void
+        unset_tracer()
+            noexcept;
+
+
         // CURLOPT_DEFAULT_PROTOCOL
         // Default protocol.
 
@@ -991,6 +1070,62 @@ namespace curl {
         unset_header_function()
             noexcept;
 
+        // Statically bound version: Func is called as std::invoke(Func, obj, ...), and obj
+        // is passed through CURLOPT_HEADERDATA, so there's no type erasure involved.
+        // Example: set_header_function<&my_class::on_header>(my_obj);
+        // Note: obj must outlive the transfer.
+
+        template<auto Func,
+                 typename T>
+        void
+        set_header_function(T& obj)
+        {
+            auto status = try_set_header_function<Func>(obj);
+            if (!status)
+                throw status.error();
+        }
+
+        template<auto Func,
+                 typename T>
+        std::expected<void, error>
+        try_set_header_function(T& obj)
+            noexcept
+        {
+            unset_header_function();
+            auto status = try_bind_static(CURLOPT_HEADERDATA,
+                                          CURLOPT_HEADERFUNCTION,
+                                          std::addressof(obj),
+                                          &static_header_callback_helper<Func, T>);
+            if (!status) {
+                unset_header_function();
+                return status;
+            }
+            extra_state.header_bound_statically = true;
+            return {};
+        }
+
+
+        // Send the headers to a sink (for instance, a header_parser), through a
+        // statically bound header function.
+        // Note: the sink must outlive the transfer.
+
+        template<typename Sink>
+        void
+        set_header_sink(Sink& sink)
+        {
+            auto status = try_set_header_sink(sink);
+            if (!status)
+                throw status.error();
+        }
+
+        template<typename Sink>
+        std::expected<void, error>
+        try_set_header_sink(Sink& sink)
+            noexcept
+        {
+            return try_set_header_function<&Sink::write>(sink);
+        }
+
 
         // CURLOPT_HEADEROPT
         // Control custom headers.
@@ -1068,6 +1203,36 @@ namespace curl {
         try_set_http_headers(slist headers)
             noexcept;
 
+        // Use a list that's shared with other handles, instead of owning a copy of it.
+        // libcurl never modifies the list, so it can be used by handles in different
+        // threads at the same time. Copies of this handle share the list too.
+        // Note: appending a header makes a private copy of the list first.
+        void
+        set_http_headers(std::shared_ptr<const slist> headers);
+
+        std::expected<void, error>
+        try_set_http_headers(std::shared_ptr<const slist> headers)
+            noexcept;
+
+        // Use a list built in a single allocation.
+        void
+        set_http_headers(arena_slist headers);
+
+        std::expected<void, error>
+        try_set_http_headers(arena_slist headers)
+            noexcept;
+
+        void
+        set_http_headers(std::shared_ptr<const arena_slist> headers);
+
+        std::expected<void, error>
+        try_set_http_headers(std::shared_ptr<const arena_slist> headers)
+            noexcept;
+
+        void
+        unset_http_headers()
+            noexcept;
+
         void
         append_http_header(const std::string& header);
 
@@ -1724,6 +1889,73 @@ namespace curl {
         unset_read_function()
             noexcept;
 
+        // Statically bound version: Func is called as std::invoke(Func, obj, ...), and obj
+        // is passed through CURLOPT_READDATA, so there's no type erasure involved.
+        // Example: set_read_function<&my_class::on_read>(my_obj);
+        // Note: obj must outlive the transfer.
+
+        template<auto Func,
+                 typename T>
+        void
+        set_read_function(T& obj)
+        {
+            auto status = try_set_read_function<Func>(obj);
+            if (!status)
+                throw status.error();
+        }
+
+        template<auto Func,
+                 typename T>
+        std::expected<void, error>
+        try_set_read_function(T& obj)
+            noexcept
+        {
+            unset_read_function();
+            auto status = try_bind_static(CURLOPT_READDATA,
+                                          CURLOPT_READFUNCTION,
+                                          std::addressof(obj),
+                                          &static_read_callback_helper<Func, T>);
+            if (!status) {
+                unset_read_function();
+                return status;
+            }
+            extra_state.read_bound_statically = true;
+            return {};
+        }
+
+
+        // Read the upload body from a source (see source.hpp), through statically bound
+        // read and seek functions. CURLOPT_INFILESIZE_LARGE is set from the source's size.
+        // Note: the source must outlive the transfer.
+
+        template<typename Source>
+        void
+        set_read_source(Source& source)
+        {
+            auto status = try_set_read_source(source);
+            if (!status)
+                throw status.error();
+        }
+
+        template<typename Source>
+        std::expected<void, error>
+        try_set_read_source(Source& source)
+            noexcept
+        {
+            auto read_status = try_set_read_function<&Source::read>(source);
+            if (!read_status)
+                return read_status;
+            auto seek_status = try_set_seek_function<&Source::seek>(source);
+            if (!seek_status)
+                return seek_status;
+            curl_off_t size = source.size();
+            if (size < 0) {
+                unset_input_file_size();
+                return {};
+            }
+            return try_set_input_file_size(size);
+        }
+
 
         // CURLOPT_REDIR_PROTOCOLS_STR
         // Protocols to allow redirects to. TODO
@@ -1794,10 +2026,58 @@ namespace curl {
         // Enable SASL initial response. TODO
 
         // CURLOPT_SEEKDATA
-        // Data pointer to pass to the seek callback. TODO
+        // Data pointer to pass to the seek callback.
+        // Note: not implemented, use a lambda with capture for the seek function.
 
         // CURLOPT_SEEKFUNCTION
-        // Callback for seek operations. TODO
+        // Callback for seek operations, to rewind the upload for redirects and multi-pass
+        // authentication.
+        // Note: the origin is SEEK_SET, SEEK_CUR or SEEK_END, like std::fseek().
+
+        void
+        set_seek_function(seek_function_t seek_func);
+
+        std::expected<void, error>
+        try_set_seek_function(seek_function_t seek_func)
+            noexcept;
+
+        void
+        unset_seek_function()
+            noexcept;
+
+        // Statically bound version: Func is called as std::invoke(Func, obj, ...), and obj
+        // is passed through CURLOPT_SEEKDATA, so there's no type erasure involved.
+        // Example: set_seek_function<&my_class::on_seek>(my_obj);
+        // Note: obj must outlive the transfer.
+
+        template<auto Func,
+                 typename T>
+        void
+        set_seek_function(T& obj)
+        {
+            auto status = try_set_seek_function<Func>(obj);
+            if (!status)
+                throw status.error();
+        }
+
+        template<auto Func,
+                 typename T>
+        std::expected<void, error>
+        try_set_seek_function(T& obj)
+            noexcept
+        {
+            unset_seek_function();
+            auto status = try_bind_static(CURLOPT_SEEKDATA,
+                                          CURLOPT_SEEKFUNCTION,
+                                          std::addressof(obj),
+                                          &static_seek_callback_helper<Func, T>);
+            if (!status) {
+                unset_seek_function();
+                return status;
+            }
+            extra_state.seek_bound_statically = true;
+            return {};
+        }
 
         // CURLOPT_SERVER_RESPONSE_TIMEOUT
         // Timeout for server responses. TODO
@@ -1809,7 +2089,20 @@ namespace curl {
         // Authentication service name. TODO
 
         // CURLOPT_SHARE
-        // Share object to use. TODO
+        // Share object to use.
+        // Note: the share object must outlive this easy handle.
+
+        void
+        set_share(share& sh);
+
+        std::expected<void, error>
+        try_set_share(share& sh)
+            noexcept;
+
+        void
+        unset_share()
+            noexcept;
+
 
         // CURLOPT_SOCKOPTDATA
         // Data pointer to pass to the sockopt callback. TODO
@@ -2246,6 +2539,111 @@ namespace curl {
         unset_write_function()
             noexcept;
 
+        // Statically bound version: Func is called as std::invoke(Func, obj, ...), and obj
+        // is passed through CURLOPT_WRITEDATA, so there's no type erasure involved.
+        // Example: set_write_function<&my_class::on_write>(my_obj);
+        // Note: obj must outlive the transfer.
+
+        template<auto Func,
+                 typename T>
+        void
+        set_write_function(T& obj)
+        {
+            auto status = try_set_write_function<Func>(obj);
+            if (!status)
+                throw status.error();
+        }
+
+        template<auto Func,
+                 typename T>
+        std::expected<void, error>
+        try_set_write_function(T& obj)
+            noexcept
+        {
+            unset_write_function();
+            auto status = try_bind_static(CURLOPT_WRITEDATA,
+                                          CURLOPT_WRITEFUNCTION,
+                                          std::addressof(obj),
+                                          &static_write_callback_helper<Func, T>);
+            if (!status) {
+                unset_write_function();
+                return status;
+            }
+            extra_state.write_bound_statically = true;
+            return {};
+        }
+
+
+        // Write the body into a sink (see sink.hpp), through a statically bound write
+        // function.
+        // Note: the sink must outlive the transfer.
+
+        template<typename Sink>
+        void
+        set_write_sink(Sink& sink)
+        {
+            auto status = try_set_write_sink(sink);
+            if (!status)
+                throw status.error();
+        }
+
+        template<typename Sink>
+        std::expected<void, error>
+        try_set_write_sink(Sink& sink)
+            noexcept
+        {
+            unset_write_function();
+            // The helper gets this object, so it can give the sink the current handle.
+            auto status = try_bind_static(CURLOPT_WRITEDATA,
+                                          CURLOPT_WRITEFUNCTION,
+                                          this,
+                                          &sink_write_callback_helper<Sink>);
+            if (!status) {
+                unset_write_function();
+                return status;
+            }
+            extra_state.write_sink = const_cast<void*>(static_cast<const void*>(&sink));
+            extra_state.write_sink_started = false;
+            return {};
+        }
+
+
+        // Collect the body in memory. The header stream is watched for Content-Length, so
+        // the buffer is reserved once per transfer, before the body arrives; max_reserve
+        // caps that reservation, for bogus lengths.
+        // Chunked or streamed responses (without a Content-Length) get no reservation:
+        // the buffer grows geometrically as the data is appended, like any std::string.
+        // The body is cleared whenever a new HTTP response starts; with other protocols
+        // it accumulates until it's taken.
+        // Note: a header function can still be used along with this. A statically bound
+        // one is not replaced; then the Content-Length is queried from libcurl instead.
+
+        static constexpr std::size_t default_memory_max_reserve = 64 * 1024 * 1024;
+
+        void
+        set_write_to_memory(std::size_t max_reserve = default_memory_max_reserve);
+
+        std::expected<void, error>
+        try_set_write_to_memory(std::size_t max_reserve = default_memory_max_reserve)
+            noexcept;
+
+        // Stop collecting the body; this resets the write function to the default.
+        void
+        unset_write_to_memory()
+            noexcept;
+
+        // The body collected so far.
+        [[nodiscard]]
+        std::string_view
+        get_memory_body()
+            const noexcept;
+
+        // Move the body out, leaving the memory buffer empty.
+        [[nodiscard]]
+        std::string
+        take_memory_body()
+            noexcept;
+
 
         // CURLOPT_WS_OPTIONS
         // Set WebSocket options.
@@ -2276,6 +2674,40 @@ namespace curl {
         unset_xfer_info_function()
             noexcept;
 
+        // Statically bound version: Func is called as std::invoke(Func, obj, ...), and obj
+        // is passed through CURLOPT_XFERINFODATA, so there's no type erasure involved.
+        // Example: set_xfer_info_function<&my_class::on_xfer_info>(my_obj);
+        // Note: obj must outlive the transfer.
+
+        template<auto Func,
+                 typename T>
+        void
+        set_xfer_info_function(T& obj)
+        {
+            auto status = try_set_xfer_info_function<Func>(obj);
+            if (!status)
+                throw status.error();
+        }
+
+        template<auto Func,
+                 typename T>
+        std::expected<void, error>
+        try_set_xfer_info_function(T& obj)
+            noexcept
+        {
+            unset_xfer_info_function();
+            auto status = try_bind_static(CURLOPT_XFERINFODATA,
+                                          CURLOPT_XFERINFOFUNCTION,
+                                          std::addressof(obj),
+                                          &static_progress_callback_helper<Func, T>);
+            if (!status) {
+                unset_xfer_info_function();
+                return status;
+            }
+            extra_state.progress_bound_statically = true;
+            return {};
+        }
+
 
         // CURLOPT_XOAUTH2_BEARER
         // OAuth2 bearer token. TODO
@@ -2502,28 +2934,78 @@ namespace curl {
 
           CURLINFO_LOCAL_PORT
           Source port number of the last connection. TODO
+        */
 
-          CURLINFO_NAMELOOKUP_TIME
-          Time from start until name resolving completed as a double. TODO
 
-          CURLINFO_NAMELOOKUP_TIME_T
-          Time from start until name resolving completed in number of microseconds. TODO
+        // CURLINFO_NAMELOOKUP_TIME
+        // CURLINFO_NAMELOOKUP_TIME_T
+        // The time it took from the start until the name resolving was completed.
 
-          CURLINFO_NUM_CONNECTS
-          Number of new successful connections used for previous transfer. TODO
+        std::chrono::microseconds
+        get_name_lookup_time()
+            const;
+
+        std::expected<std::chrono::microseconds, error>
+        try_get_name_lookup_time()
+            const noexcept;
 
-          CURLINFO_OS_ERRNO
-          The errno from the last failure to connect. TODO
 
-          CURLINFO_POSTTRANSFER_TIME_T
-          The time it took from the start until the last byte is sent by libcurl. In microseconds. (Added in 8.10.0) TODO
+        // CURLINFO_NUM_CONNECTS
+        // Number of new connections libcurl had to create for the previous transfer; zero
+        // means an existing connection was reused.
 
-          CURLINFO_PRETRANSFER_TIME
-          The time it took from the start until the file transfer is just about to begin. This includes all pre-transfer commands and negotiations that are specific to the particular protocol(s) involved. TODO
+        long
+        get_num_connects()
+            const;
 
-          CURLINFO_PRETRANSFER_TIME_T
-          The time it took from the start until the file transfer is just about to begin. This includes all pre-transfer commands and negotiations that are specific to the particular protocol(s) involved. In microseconds. TODO
+        std::expected<long, error>
+        try_get_num_connects()
+            const noexcept;
 
+
+        // CURLINFO_OS_ERRNO
+        // The errno from the last failure to connect.
+
+        long
+        get_os_errno()
+            const;
+
+        std::expected<long, error>
+        try_get_os_errno()
+            const noexcept;
+
+
+#if CURL_AT_LEAST_VERSION(8, 10, 0)
+
+        // CURLINFO_POSTTRANSFER_TIME_T
+        // The time it took from the start until the last byte was sent.
+
+        std::chrono::microseconds
+        get_post_transfer_time()
+            const;
+
+        std::expected<std::chrono::microseconds, error>
+        try_get_post_transfer_time()
+            const noexcept;
+
+#endif // CURL_AT_LEAST_VERSION(8, 10, 0)
+
+
+        // CURLINFO_PRETRANSFER_TIME
+        // CURLINFO_PRETRANSFER_TIME_T
+        // The time it took from the start until the file transfer was just about to begin,
+        // including all the protocol-specific negotiations.
+
+        std::chrono::microseconds
+        get_pre_transfer_time()
+            const;
+
+        std::expected<std::chrono::microseconds, error>
+        try_get_pre_transfer_time()
+            const noexcept;
+
+
+        /*
           CURLINFO_PRIMARY_IP
           Destination IP address of the last connection. TODO
 
@@ -2556,19 +3038,52 @@ namespace curl {
 
           CURLINFO_PROXY_SSL_VERIFYRESULT
           Proxy certificate verification result. TODO
+        */
+
+
+#if CURL_AT_LEAST_VERSION(8, 6, 0)
+
+        // CURLINFO_QUEUE_TIME_T
+        // The time the transfer was held in a waiting queue before it could start.
+
+        std::chrono::microseconds
+        get_queue_time()
+            const;
+
+        std::expected<std::chrono::microseconds, error>
+        try_get_queue_time()
+            const noexcept;
+
+#endif // CURL_AT_LEAST_VERSION(8, 6, 0)
+
+
+        // CURLINFO_REDIRECT_COUNT
+        // Total number of redirects that were followed.
+
+        long
+        get_redirect_count()
+            const;
 
-          CURLINFO_QUEUE_TIME_T
-          The time during which the transfer was held in a waiting queue before it could start for real in number of microseconds. (Added in 8.6.0) TODO
+        std::expected<long, error>
+        try_get_redirect_count()
+            const noexcept;
 
-          CURLINFO_REDIRECT_COUNT
-          Total number of redirects that were followed. TODO
 
-          CURLINFO_REDIRECT_TIME
-          The time it took for all redirection steps include name lookup, connect, pretransfer and transfer before final transaction was started. So, this is zero if no redirection took place. As a double. TODO
+        // CURLINFO_REDIRECT_TIME
+        // CURLINFO_REDIRECT_TIME_T
+        // The time it took for all the redirection steps before the final transaction was
+        // started; zero if no redirection took place.
 
-          CURLINFO_REDIRECT_TIME_T
-          The time it took for all redirection steps include name lookup, connect, pretransfer and transfer before final transaction was started. So, this is zero if no redirection took place. In number of microseconds. TODO
+        std::chrono::microseconds
+        get_redirect_time()
+            const;
 
+        std::expected<std::chrono::microseconds, error>
+        try_get_redirect_time()
+            const noexcept;
+
+
+        /*
           CURLINFO_REDIRECT_URL
           URL a redirect would take you to, had you enabled redirects. TODO
 
@@ -2728,6 +3243,54 @@ namespace curl {
         /*----------------------*/
 
 
+        // Timing and size information about the previous transfer, gathered in one call.
+        // All times are measured from the start of the transfer, so each phase's duration
+        // is the difference between consecutive times:
+        //     queue <= name_lookup <= connect <= app_connect <= pre_transfer
+        //           <= post_transfer <= start_transfer <= total
+        // Times that don't apply are zero, and must be skipped in that order: app_connect
+        // is zero when there was no TLS (or other application protocol) handshake, like
+        // in plain HTTP; queue and post_transfer are zero with older libcurl versions.
+        // When redirects were followed, libcurl adds up the times of all the requests, and
+        // redirect is the time spent before the final one started.
+        struct transfer_stats {
+            // Zero if libcurl is older than 8.6.0.
+            std::chrono::microseconds queue{};
+            std::chrono::microseconds name_lookup{};
+            std::chrono::microseconds connect{};
+            std::chrono::microseconds app_connect{};
+            std::chrono::microseconds pre_transfer{};
+            // Zero if libcurl is older than 8.10.0.
+            std::chrono::microseconds post_transfer{};
+            std::chrono::microseconds start_transfer{};
+            std::chrono::microseconds total{};
+            std::chrono::microseconds redirect{};
+
+            curl_off_t size_download = 0;
+            curl_off_t size_upload = 0;
+            long header_size = 0;
+            long request_size = 0;
+
+            // -1 if unknown, or if libcurl is older than 8.2.0.
+            curl_off_t conn_id = -1;
+            long num_connects = 0;
+            // No new connection was made, but one was used (the transfer got to the
+            // pre-transfer stage); a transfer that failed to connect is not a reuse.
+            bool reused_connection = false;
+            long redirect_count = 0;
+            long response_code = 0;
+        };
+
+
+        transfer_stats
+        get_transfer_stats()
+            const;
+
+        std::expected<transfer_stats, error>
+        try_get_transfer_stats()
+            const noexcept;
+
+
         header
         get_header(const std::string& name,
                    std::size_t index = 0,
@@ -2744,6 +3307,59 @@ namespace curl {
             const noexcept;
 
 
+        // Non-owning versions of get_header(), they don't allocate.
+        // Note: the header is only valid until the next transfer on this handle.
+
+        header_view
+        get_header_view(const char* name,
+                        std::size_t index = 0,
+                        unsigned origin = CURLH_HEADER,
+                        int request = -1)
+            const;
+
+        header_view
+        get_header_view(const std::string& name,
+                        std::size_t index = 0,
+                        unsigned origin = CURLH_HEADER,
+                        int request = -1)
+            const;
+
+
+        std::expected<header_view, error>
+        try_get_header_view(const char* name,
+                            std::size_t index = 0,
+                            unsigned origin = CURLH_HEADER,
+                            int request = -1)
+            const noexcept;
+
+        std::expected<header_view, error>
+        try_get_header_view(const std::string& name,
+                            std::size_t index = 0,
+                            unsigned origin = CURLH_HEADER,
+                            int request = -1)
+            const noexcept;
+
+        // Like try_get_header_view(), but a missing header doesn't construct an error
+        // (which allocates the error message).
+        [[nodiscard]]
+        std::optional<header_view>
+        find_header_view(const char* name,
+                         std::size_t index = 0,
+                         unsigned origin = CURLH_HEADER,
+                         int request = -1)
+            const noexcept;
+
+
+        // Iterate over all the headers with the given origin (a bitmask of CURLH_*
+        // values), from the given request (-1 means the last one), without allocating.
+        // Note: the headers are only valid until the next transfer on this handle.
+        [[nodiscard]]
+        header_range
+        get_headers(unsigned origin = CURLH_HEADER,
+                    int request = -1)
+            const noexcept;
+
+
         [[nodiscard]]
         static
         easy*
@@ -2753,17 +3369,93 @@ namespace curl {
 
     private:
 
+        friend struct multi;
+
+
         void
         setup_extra_state();
 
 
+        std::expected<void, error>
+        try_set_shared_http_headers(std::shared_ptr<const curl_slist> headers)
+            noexcept;
+
+
+        // Take ownership of a handle that libcurl duplicated from original (like a server
+        // push), giving it a copy of the original's state.
+        void
+        adopt_duplicate(CURL* new_raw,
+                        const easy* original);
+
+        // A server push doesn't share the callbacks of its parent, but libcurl duplicated
+        // them, with the *DATA options pointing to the parent, or to the objects it bound
+        // statically. Remove the ones the original had; all of them if original is null.
+        void
+        unset_duplicated_callbacks(const extra_state_type* original)
+            noexcept;
+
+
+        // Pick the tracer id for the next transfer, and enable the debug callback if it's
+        // sampled.
+        void
+        start_trace()
+            noexcept;
+
+        // Record the end of the traced transfer, and start the next one.
+        void
+        finish_trace(CURLcode result)
+            noexcept;
+
+        // Called when a transfer starts, from perform() or when added to a multi handle.
+        void
+        start_transfer()
+            noexcept;
+
+        // Called when a transfer is done, from perform() or from the multi handle.
+        void
+        finish_transfer(CURLcode result)
+            noexcept;
+
+        void
+        trace_debug(curl_infotype type,
+                    std::span<const char> data)
+            noexcept;
+
+
+        // Stop collecting the body in memory, if set_write_to_memory() was used.
+        void
+        stop_memory_body()
+            noexcept;
+
+
+        // Install a statically bound callback.
+        template<typename Helper,
+                 typename T>
+        std::expected<void, error>
+        try_bind_static(CURLoption data_opt,
+                        CURLoption func_opt,
+                        T* obj,
+                        Helper* helper)
+            noexcept
+        {
+            void* data_ptr = const_cast<void*>(static_cast<const void*>(obj));
+            auto e = curl_easy_setopt(raw, data_opt, data_ptr);
+            if (e != CURLE_OK)
+                return std::unexpected{error{e}};
+            e = curl_easy_setopt(raw, func_opt, helper);
+            if (e != CURLE_OK)
+                return std::unexpected{error{e}};
+            return {};
+        }
+
+
         /*------------------*/
         /* Callback helpers */
         /*------------------*/
 
         static
         int
-        closesocket_callback_helper(CURL* handle,
+        closesocket_callback_helper(easy* ez,
                                     curl_socket_t fd)
             noexcept;
 
@@ -2773,12 +3465,12 @@ namespace curl {
                               curl_infotype type,
                               char *data,
                               std::size_t size,
-                              CURL* handle)
+                              easy* ez)
             noexcept;
 
         static
         int
-        fnmatch_callback_helper(CURL* handle,
+        fnmatch_callback_helper(easy* ez,
                                 const char* pattern,
                                 const char* text)
             noexcept;
@@ -2788,20 +3480,28 @@ namespace curl {
         header_callback_helper(char* buffer,
                                std::size_t size,
                                std::size_t nitems,
-                               CURL* handle)
+                               easy* ez)
             noexcept;
 
 
+        static
+        std::size_t
+        memory_write_callback_helper(const char* buffer,
+                                     std::size_t,
+                                     std::size_t size,
+                                     easy* ez)
+            noexcept;
+
         static
         curl_socket_t
-        opensocket_callback_helper(CURL* handle,
+        opensocket_callback_helper(easy* ez,
                                   curlsocktype purpose,
                                   curl_sockaddr* address)
             noexcept;
 
         static
         int
-        progress_callback_helper(CURL* handle,
+        progress_callback_helper(easy* ez,
                                  curl_off_t dltotal,
                                  curl_off_t dlnow,
                                  curl_off_t ultotal,
@@ -2813,7 +3513,21 @@ namespace curl {
         read_callback_helper(char* buffer,
                              std::size_t,
                              std::size_t size,
-                             CURL* handle)
+                             easy* ez)
+            noexcept;
+
+        static
+        int
+        resolver_start_callback_helper(void* resolver_state,
+                                       void* reserved,
+                                       easy* ez)
+            noexcept;
+
+        static
+        int
+        seek_callback_helper(easy* ez,
+                             curl_off_t offset,
+                             int origin)
             noexcept;
 
         static
@@ -2821,10 +3535,142 @@ namespace curl {
         write_callback_helper(const char* buffer,
                               std::size_t,
                               std::size_t size,
-                              CURL* handle)
+                              easy* ez)
             noexcept;
 
 
+        /*------------------------------*/
+        /* Statically bound callbacks   */
+        /*------------------------------*/
+
+        template<auto Func,
+                 typename T>
+        static
+        std::size_t
+        static_header_callback_helper(char* buffer,
+                                      std::size_t size,
+                                      std::size_t nitems,
+                                      void* obj)
+            noexcept
+        {
+            try {
+                return std::invoke(Func,
+                                   *static_cast<T*>(obj),
+                                   std::span<const char>{buffer, size * nitems});
+            }
+            catch (...) {
+                return CURL_WRITEFUNC_ERROR;
+            }
+        }
+
+        template<auto Func,
+                 typename T>
+        static
+        int
+        static_progress_callback_helper(void* obj,
+                                        curl_off_t dltotal,
+                                        curl_off_t dlnow,
+                                        curl_off_t ultotal,
+                                        curl_off_t ulnow)
+            noexcept
+        {
+            try {
+                return std::invoke(Func,
+                                   *static_cast<T*>(obj),
+                                   dltotal,
+                                   dlnow,
+                                   ultotal,
+                                   ulnow);
+            }
+            catch (...) {
+                return 1; // cause CURLE_ABORTED_BY_CALLBACK error
+            }
+        }
+
+        template<auto Func,
+                 typename T>
+        static
+        std::size_t
+        static_read_callback_helper(char* buffer,
+                                    std::size_t,
+                                    std::size_t size,
+                                    void* obj)
+            noexcept
+        {
+            try {
+                return std::invoke(Func,
+                                   *static_cast<T*>(obj),
+                                   std::span<char>{buffer, size});
+            }
+            catch (...) {
+                return CURL_READFUNC_ABORT;
+            }
+        }
+
+        template<auto Func,
+                 typename T>
+        static
+        int
+        static_seek_callback_helper(void* obj,
+                                    curl_off_t offset,
+                                    int origin)
+            noexcept
+        {
+            try {
+                return std::invoke(Func, *static_cast<T*>(obj), offset, origin);
+            }
+            catch (...) {
+                return CURL_SEEKFUNC_FAIL;
+            }
+        }
+
+        template<typename Sink>
+        static
+        std::size_t
+        sink_write_callback_helper(const char* buffer,
+                                   std::size_t,
+                                   std::size_t size,
+                                   easy* ez)
+            noexcept
+        {
+            if (!ez || !ez->extra_state.write_sink)
+                return CURL_WRITEFUNC_ERROR;
+            auto& sink = *static_cast<Sink*>(ez->extra_state.write_sink);
+            try {
+                if constexpr (requires { sink.start(ez->raw); }) {
+                    if (!ez->extra_state.write_sink_started) {
+                        ez->extra_state.write_sink_started = true;
+                        sink.start(ez->raw);
+                    }
+                }
+                return sink.write(std::span<const char>{buffer, size});
+            }
+            catch (...) {
+                return CURL_WRITEFUNC_ERROR;
+            }
+        }
+
+        template<auto Func,
+                 typename T>
+        static
+        std::size_t
+        static_write_callback_helper(const char* buffer,
+                                     std::size_t,
+                                     std::size_t size,
+                                     void* obj)
+            noexcept
+        {
+            try {
+                return std::invoke(Func,
+                                   *static_cast<T*>(obj),
+                                   std::span<const char>{buffer, size});
+            }
+            catch (...) {
+                return CURL_WRITEFUNC_ERROR;
+            }
+        }
+
+
         /*--------------*/
         /* Private data */
         /*--------------*/
@@ -0,0 +1,84 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef CURLXX_EASY_POOL_HPP
+#define CURLXX_EASY_POOL_HPP
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "easy.hpp"
+
+
+namespace curl {
+
+    // Keeps released easy handles around, so they can be reused without calling
+    // curl_easy_init()/curl_easy_cleanup() again. A reused handle keeps its connection
+    // cache, DNS cache and TLS session cache.
+    // This class is thread-safe.
+    class easy_pool {
+
+    public:
+
+        using setup_function_t = std::move_only_function<void (easy& ez)>;
+
+    private:
+
+        mutable std::mutex mutex;
+        std::vector<easy> idle;
+        std::size_t max_idle;
+        setup_function_t setup;
+
+
+        void
+        prepare(easy& ez);
+
+    public:
+
+        // Keep up to max_idle handles around.
+        // The optional setup function is called on every handle before it's handed out;
+        // reused handles are reset before that.
+        explicit
+        easy_pool(std::size_t max_idle = 64,
+                  setup_function_t setup = {});
+
+
+        // Get an idle handle, or create a new one.
+        [[nodiscard]]
+        easy
+        acquire();
+
+
+        // Return a handle to the pool. It's reset and prepared immediately, so the next
+        // acquire() is cheap. If the pool is full, the handle is destroyed.
+        void
+        release(easy ez);
+
+
+        // Create handles until there are n idle handles.
+        void
+        reserve(std::size_t n);
+
+
+        // Destroy all idle handles.
+        void
+        clear()
+            noexcept;
+
+
+        [[nodiscard]]
+        std::size_t
+        get_idle()
+            const;
+
+    }; // class easy_pool
+
+} // namespace curl
+
+#endif
@@ -0,0 +1,102 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef CURLXX_EPOLL_LOOP_HPP
+#define CURLXX_EPOLL_LOOP_HPP
+
+#include <chrono>
+#include <cstdint>
+
+#include <curl/curl.h>
+
+
+namespace curl {
+
+    struct multi;
+
+
+    // Event loop that drives a multi handle through curl_multi_socket_action(), using
+    // epoll for the sockets and a timerfd for libcurl's timeout.
+    // Only the sockets that are ready get processed on each wakeup.
+    //
+    // Note: the socket and timer functions of the multi handle are taken over by this
+    // object, until it's destroyed. The multi handle must outlive this object, and must
+    // not be moved (or move-assigned to) while this object exists, since only its address
+    // is kept.
+    //
+    // Only available when CURLXX_HAVE_EPOLL_LOOP is defined to 1 in <curlxx/features.hpp>.
+    class epoll_loop {
+
+        multi* target = nullptr;
+        int epoll_fd = -1;
+        int timer_fd = -1;
+        unsigned running = 0;
+        std::uint64_t wakeups = 0;
+
+
+        int
+        on_socket(curl_socket_t s,
+                  int what,
+                  void* socket_data);
+
+        int
+        on_timer(std::chrono::milliseconds timeout);
+
+        void
+        close_fds()
+            noexcept;
+
+    public:
+
+        explicit
+        epoll_loop(multi& m);
+
+        // This object can't be moved, the callbacks refer to it.
+        epoll_loop(const epoll_loop&) = delete;
+
+        ~epoll_loop()
+            noexcept;
+
+
+        // Wait until a socket or the timer is ready, and let libcurl process them.
+        // A negative timeout waits indefinitely.
+        // Returns the number of running handles.
+        unsigned
+        run_once(std::chrono::milliseconds timeout = std::chrono::milliseconds{-1});
+
+
+        // Keep calling run_once() until there are no more running handles.
+        // Note: completed transfers still need to be collected with multi::get_done().
+        void
+        run();
+
+
+        [[nodiscard]]
+        unsigned
+        get_running()
+            const noexcept;
+
+
+        // How many times the loop woke up from epoll_wait().
+        [[nodiscard]]
+        std::uint64_t
+        get_wakeups()
+            const noexcept;
+
+
+        // The epoll file descriptor. It can be nested into another poll/epoll loop, as it
+        // becomes readable when run_once() has work to do.
+        [[nodiscard]]
+        int
+        get_fd()
+            const noexcept;
+
+    }; // class epoll_loop
+
+} // namespace curl
+
+#endif
@@ -28,6 +28,10 @@ namespace curl {
     to_string(CURLHcode code);
 
 
+    std::string
+    to_string(CURLSHcode code);
+
+
     std::string
     to_string(CURLUcode code);
 
@@ -44,6 +48,8 @@ namespace curl {
 
         error(CURLHcode code);
 
+        error(CURLSHcode code);
+
         error(CURLsslset code);
 
         error(CURLUcode code);
@@ -1,6 +1,6 @@
 /*
  * curlxx - A C++ wrapper for libcurl.
- * Copyright 2025  Daniel K. O. (dkosmari)
+ * Copyright 2025-2026  Daniel K. O. (dkosmari)
  *
  * SPDX-License-Identifier: LGPL-3.0-or-later
  */
@@ -8,14 +8,37 @@
 #ifndef CURLXX_HEADER_HPP
 #define CURLXX_HEADER_HPP
 
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <string>
+#include <string_view>
 
 #include <curl/curl.h>
 
 
 namespace curl {
 
+    // Non-owning version of header: the name and value point into libcurl's storage.
+    // Note: only valid until the next transfer on the handle.
+    struct header_view {
+
+        std::string_view name;
+        std::string_view value;
+        std::size_t amount = 0;
+        std::size_t index = 0;
+        unsigned origin = 0;
+
+        constexpr
+        header_view()
+            noexcept = default;
+
+        header_view(const curl_header* h)
+            noexcept;
+
+    }; // struct header_view
+
+
     struct header {
 
         std::string name;
@@ -30,8 +53,110 @@ namespace curl {
 
         header(const curl_header* h);
 
+        explicit
+        header(const header_view& hv);
+
     }; // struct header
 
+
+    // Lazy range over the headers of a transfer, using curl_easy_nextheader().
+    // Nothing is allocated, each header is a header_view.
+    // Note: libcurl reuses the same storage for all iterations on a handle, so this is a
+    // single-pass range, and only one iteration at a time can be active on a handle.
+    class header_range {
+
+        CURL* handle;
+        unsigned origin;
+        int request;
+
+    public:
+
+        class iterator {
+
+            CURL* handle = nullptr;
+            unsigned origin = 0;
+            int request = 0;
+            curl_header* current = nullptr;
+            header_view view;
+
+
+            void
+            advance()
+                noexcept;
+
+        public:
+
+            using value_type = header_view;
+            using difference_type = std::ptrdiff_t;
+
+
+            constexpr
+            iterator()
+                noexcept = default;
+
+            iterator(CURL* handle,
+                     unsigned origin,
+                     int request)
+                noexcept;
+
+
+            const header_view&
+            operator *()
+                const noexcept
+            {
+                return view;
+            }
+
+            const header_view*
+            operator ->()
+                const noexcept
+            {
+                return &view;
+            }
+
+
+            iterator&
+            operator ++()
+                noexcept
+            {
+                advance();
+                return *this;
+            }
+
+            void
+            operator ++(int)
+                noexcept
+            {
+                advance();
+            }
+
+
+            bool
+            operator ==(std::default_sentinel_t)
+                const noexcept
+            {
+                return !current;
+            }
+
+        }; // class iterator
+
+
+        header_range(CURL* handle,
+                     unsigned origin,
+                     int request)
+            noexcept;
+
+
+        iterator
+        begin()
+            const noexcept;
+
+        std::default_sentinel_t
+        end()
+            const noexcept;
+
+    }; // class header_range
+
 } // namespace curl
 
 #endif
@@ -0,0 +1,291 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef CURLXX_HEADER_PARSER_HPP
+#define CURLXX_HEADER_PARSER_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+
+
+namespace curl {
+
+    // A string that can be used as a template argument.
+    template<std::size_t N>
+    struct fixed_string {
+
+        char data[N] = {};
+
+        consteval
+        fixed_string(const char (&str)[N])
+            noexcept
+        {
+            std::copy_n(str, N, data);
+        }
+
+        constexpr
+        std::string_view
+        view()
+            const noexcept
+        {
+            return {data, N - 1};
+        }
+
+    }; // struct fixed_string
+
+
+    namespace detail {
+
+        constexpr
+        char
+        ascii_tolower(char c)
+            noexcept
+        {
+            return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+
+        constexpr
+        bool
+        equal_icase(std::string_view a,
+                    std::string_view b)
+            noexcept
+        {
+            if (a.size() != b.size())
+                return false;
+            for (std::size_t i = 0; i < a.size(); ++i)
+                if (ascii_tolower(a[i]) != ascii_tolower(b[i]))
+                    return false;
+            return true;
+        }
+
+
+        // Case-insensitive FNV-1a.
+        constexpr
+        std::uint32_t
+        hash_icase(std::string_view str,
+                   std::uint32_t seed)
+            noexcept
+        {
+            std::uint32_t h = 2166136261u ^ seed;
+            for (char c : str) {
+                h ^= static_cast<unsigned char>(ascii_tolower(c));
+                h *= 16777619u;
+            }
+            return h;
+        }
+
+    } // namespace detail
+
+
+    // A compile-time set of header names, matched case-insensitively with a perfect hash:
+    // looking up a name costs one hash and at most one comparison.
+    // Example:
+    //     using interesting = curl::header_names<"Content-Type", "ETag">;
+    //     interesting::find("etag") == interesting::index_of<"ETag">()
+    template<fixed_string... Names>
+    class header_names {
+
+        static constexpr std::array<std::string_view, sizeof...(Names)> names{
+            Names.view()...
+        };
+
+        static constexpr std::size_t table_size = std::bit_ceil(2 * sizeof...(Names) + 1);
+
+
+        struct table_type {
+            std::uint32_t seed = 0;
+            // Index into names, plus one; zero means an empty slot.
+            std::array<std::uint8_t, table_size> slots{};
+        };
+
+
+        static consteval
+        table_type
+        build_table()
+        {
+            static_assert(sizeof...(Names) < std::numeric_limits<std::uint8_t>::max(),
+                          "too many header names");
+            for (std::uint32_t seed = 0; ; ++seed) {
+                table_type table{seed, {}};
+                bool ok = true;
+                for (std::size_t i = 0; ok && i < names.size(); ++i) {
+                    auto& slot = table.slots[detail::hash_icase(names[i], seed)
+                                             & (table_size - 1)];
+                    if (slot) {
+                        // Either a collision, or a duplicated name.
+                        if (detail::equal_icase(names[slot - 1], names[i]))
+                            throw "duplicated header name";
+                        ok = false;
+                    } else
+                        slot = i + 1;
+                }
+                if (ok)
+                    return table;
+            }
+        }
+
+
+        static constexpr table_type table = build_table();
+
+    public:
+
+        static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+
+        [[nodiscard]]
+        static constexpr
+        std::size_t
+        size()
+            noexcept
+        {
+            return sizeof...(Names);
+        }
+
+
+        // Returns the index of name in the set, or npos.
+        [[nodiscard]]
+        static constexpr
+        std::size_t
+        find(std::string_view name)
+            noexcept
+        {
+            auto slot = table.slots[detail::hash_icase(name, table.seed) & (table_size - 1)];
+            if (!slot)
+                return npos;
+            if (!detail::equal_icase(names[slot - 1], name))
+                return npos;
+            return slot - 1;
+        }
+
+
+        template<fixed_string Name>
+        [[nodiscard]]
+        static consteval
+        std::size_t
+        index_of()
+            noexcept
+        {
+            std::size_t result = find(Name.view());
+            if (result == npos)
+                throw "header name is not in the set";
+            return result;
+        }
+
+    }; // class header_names
+
+
+    // Parses the header stream of a transfer: the status line of each response, the
+    // header fields (unfolding obsolete line folding), and the empty line that ends each
+    // response block (so redirects and 100-continue responses can be told apart).
+    // Use it with easy::set_header_sink().
+    //
+    // An optional matcher selects the interesting headers (see header_names::find());
+    // the other ones are skipped without being copied.
+    //
+    // Note: the string_views passed to the callbacks are only valid during the call.
+    class header_parser {
+
+    public:
+
+        static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+
+        struct status_line {
+            std::string_view version; // "HTTP/1.1", "HTTP/2", etc
+            int code = 0;
+            std::string_view reason;
+        };
+
+
+        // Returns an identifier for the header name, or npos to skip it.
+        using matcher_t = std::size_t (*)(std::string_view name) noexcept;
+
+        using status_callback_signature = void (const status_line& status);
+
+        // The id is what the matcher returned, or npos if there's no matcher.
+        using header_callback_signature = void (std::size_t id,
+                                                std::string_view name,
+                                                std::string_view value);
+
+        // Called at the end of each response block, with its status code.
+        using end_callback_signature = void (int code);
+
+        using status_function_t = std::move_only_function<status_callback_signature>;
+        using header_function_t = std::move_only_function<header_callback_signature>;
+        using end_function_t    = std::move_only_function<end_callback_signature>;
+
+    private:
+
+        matcher_t matcher;
+        status_function_t status_func;
+        header_function_t header_func;
+        end_function_t end_func;
+
+        // The last header is held until the next line, in case it's folded.
+        std::string pending;
+        std::size_t pending_name_size = 0;
+        std::size_t pending_id = npos;
+        bool has_pending = false;
+
+        int status_code = 0;
+
+
+        void
+        flush();
+
+    public:
+
+        explicit
+        header_parser(matcher_t matcher = nullptr)
+            noexcept;
+
+
+        void
+        set_status_function(status_function_t func)
+            noexcept;
+
+        void
+        set_header_function(header_function_t func)
+            noexcept;
+
+        void
+        set_end_function(end_function_t func)
+            noexcept;
+
+
+        // Feed one header line, as delivered by libcurl.
+        // Returns data.size().
+        std::size_t
+        write(std::span<const char> data);
+
+
+        // Forget any partially parsed response.
+        void
+        reset()
+            noexcept;
+
+
+        // Status code of the last status line seen.
+        [[nodiscard]]
+        int
+        get_status_code()
+            const noexcept;
+
+    }; // class header_parser
+
+} // namespace curl
+
+#endif
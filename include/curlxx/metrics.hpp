@@ -0,0 +1,280 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef CURLXX_METRICS_HPP
+#define CURLXX_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "easy.hpp"
+
+
+namespace curl {
+
+    // A log-linear (HDR-style) histogram of durations, with microsecond resolution.
+    // Each power of two is split into 16 buckets, so any recorded value is off by at most
+    // 1/16 of itself; values above 2^40 us (about 12 days) are clamped.
+    // The memory is fixed, and recording is lock-free, so one histogram can be fed from
+    // multiple threads.
+    class latency_histogram {
+
+    public:
+
+        static constexpr unsigned sub_bucket_bits = 4;
+        static constexpr unsigned sub_buckets = 1u << sub_bucket_bits;
+        static constexpr unsigned max_value_bits = 40;
+        static constexpr std::size_t num_buckets =
+            sub_buckets * (max_value_bits - sub_bucket_bits + 1);
+
+
+        // A copy of the counters, taken at some point in time.
+        // Note: since recording doesn't stop while the copy is made, sum and max might
+        // not agree exactly with the bucket counts.
+        struct snapshot {
+
+            std::array<std::uint64_t, num_buckets> counts{};
+            std::uint64_t count = 0;
+            std::chrono::microseconds sum{};
+            std::chrono::microseconds max{};
+
+
+            // Returns the smallest value that is greater than or equal to a fraction q
+            // (between 0 and 1) of the recorded values.
+            [[nodiscard]]
+            std::chrono::microseconds
+            value_at_quantile(double q)
+                const noexcept;
+
+            // How many values are known to be no greater than limit.
+            [[nodiscard]]
+            std::uint64_t
+            count_at_most(std::chrono::microseconds limit)
+                const noexcept;
+
+        }; // struct snapshot
+
+
+        latency_histogram()
+            noexcept = default;
+
+        latency_histogram(const latency_histogram&) = delete;
+
+
+        void
+        record(std::chrono::microseconds value)
+            noexcept;
+
+
+        [[nodiscard]]
+        snapshot
+        get_snapshot()
+            const noexcept;
+
+
+        void
+        reset()
+            noexcept;
+
+
+        [[nodiscard]]
+        static
+        std::size_t
+        bucket_index(std::uint64_t value)
+            noexcept;
+
+        // The range of values in a bucket (inclusive).
+        [[nodiscard]]
+        static
+        std::pair<std::uint64_t, std::uint64_t>
+        bucket_range(std::size_t index)
+            noexcept;
+
+    private:
+
+        std::array<std::atomic<std::uint64_t>, num_buckets> counts{};
+        std::atomic<std::uint64_t> sum = 0;
+        std::atomic<std::uint64_t> max = 0;
+
+    }; // class latency_histogram
+
+
+    // The phases of a transfer, as measured by libcurl.
+    enum class transfer_phase : unsigned {
+        queue,          // waiting in the multi handle's queue (libcurl 8.6.0+)
+        name_lookup,    // resolving the host name; only for new connections
+        connect,        // TCP (or QUIC) connect; only for new connections
+        tls,            // TLS handshake; only for new TLS connections
+        server_wait,    // from the start of the request until the first response byte
+        body,           // from the first to the last response byte
+        total,
+    };
+
+    inline constexpr std::size_t num_transfer_phases = 7;
+
+
+    [[nodiscard]]
+    std::string_view
+    to_string(transfer_phase phase)
+        noexcept;
+
+
+    // Metrics for the transfers to one host.
+    struct host_metrics {
+
+        std::array<latency_histogram, num_transfer_phases> phases;
+
+        std::atomic<std::uint64_t> transfers = 0;
+        std::atomic<std::uint64_t> bytes_downloaded = 0;
+        std::atomic<std::uint64_t> bytes_uploaded = 0;
+        std::atomic<std::uint64_t> new_connections = 0;
+        std::atomic<std::uint64_t> reused_connections = 0;
+        // Indexed by CURLcode; results[CURLE_OK] counts the successful transfers.
+        std::array<std::atomic<std::uint64_t>, CURL_LAST> results{};
+
+
+        [[nodiscard]]
+        latency_histogram&
+        operator [](transfer_phase phase)
+            noexcept
+        {
+            return phases[static_cast<unsigned>(phase)];
+        }
+
+    }; // struct host_metrics
+
+
+    struct host_metrics_snapshot {
+
+        std::string host;
+
+        std::array<latency_histogram::snapshot, num_transfer_phases> phases;
+
+        std::uint64_t transfers = 0;
+        std::uint64_t bytes_downloaded = 0;
+        std::uint64_t bytes_uploaded = 0;
+        std::uint64_t new_connections = 0;
+        std::uint64_t reused_connections = 0;
+        // Only the failures that happened, in CURLcode order.
+        std::vector<std::pair<CURLcode, std::uint64_t>> errors;
+
+
+        [[nodiscard]]
+        const latency_histogram::snapshot&
+        operator [](transfer_phase phase)
+            const noexcept
+        {
+            return phases[static_cast<unsigned>(phase)];
+        }
+
+    }; // struct host_metrics_snapshot
+
+
+    // Collects metrics from completed transfers, grouped by host (and port).
+    // Use it with multi::set_metrics(), or call record() directly after easy::perform().
+    // All member functions are thread-safe; a registry can be shared by multiple multi
+    // handles. Finding a host takes a shared lock (an exclusive one only the first time the
+    // host is seen), while the counters are updated lock-free.
+    //
+    // Only successful transfers are recorded in the latency histograms; failed ones are
+    // only counted, by CURLcode.
+    class metrics_registry {
+
+        struct string_hash {
+            using is_transparent = void;
+
+            std::size_t
+            operator ()(std::string_view str)
+                const noexcept
+            {
+                return std::hash<std::string_view>{}(str);
+            }
+        };
+
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string,
+                           std::unique_ptr<host_metrics>,
+                           string_hash,
+                           std::equal_to<>> hosts;
+
+    public:
+
+        metrics_registry() = default;
+
+        metrics_registry(const metrics_registry&) = delete;
+
+
+        // Returns the metrics for host, creating them if needed, or null if there's no
+        // memory for them.
+        host_metrics*
+        find_or_create(std::string_view host)
+            noexcept;
+
+
+        // Record a completed transfer. The host is taken from the effective URL.
+        // Only the info that's recorded is queried from libcurl; this is what
+        // multi::set_metrics() uses.
+        void
+        record(const easy& ez,
+               CURLcode result)
+            noexcept;
+
+        // Record a transfer whose stats were already gathered.
+        void
+        record(std::string_view host,
+               const easy::transfer_stats& stats,
+               CURLcode result)
+            noexcept;
+
+
+        [[nodiscard]]
+        std::vector<host_metrics_snapshot>
+        get_snapshot()
+            const;
+
+
+        // Zero all the counters. The hosts are not removed, so the pointers returned by
+        // find_or_create() stay valid.
+        void
+        reset()
+            noexcept;
+
+    }; // class metrics_registry
+
+
+    // Returns the metrics in the Prometheus text exposition format. Each phase is
+    // exported as a histogram (in seconds), with a fixed set of buckets, from 100 us to
+    // 60 s; their counts are rounded down to the resolution of latency_histogram.
+    [[nodiscard]]
+    std::string
+    format_prometheus(std::span<const host_metrics_snapshot> snapshot,
+                      std::string_view prefix = "curlxx");
+
+
+    // Returns the metrics as a JSON object. Each phase is summarized by its count, sum,
+    // max and a few quantiles (p50, p90, p99, p999), all in microseconds.
+    [[nodiscard]]
+    std::string
+    format_json(std::span<const host_metrics_snapshot> snapshot);
+
+} // namespace curl
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef CURLXX_DETAIL_MPSC_QUEUE_HPP
+#define CURLXX_DETAIL_MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+
+namespace curl::detail {
+
+    // Lock-free unbounded queue, for multiple producers and a single consumer.
+    // Producers never wait on each other; the consumer might not see an element until its
+    // producer finished linking it, so pop() can spuriously return nothing while a push()
+    // is in progress.
+    template<typename T>
+    class mpsc_queue {
+
+        struct node {
+            std::atomic<node*> next = nullptr;
+            std::optional<T> value;
+        };
+
+        // Producers push at the head.
+        std::atomic<node*> head;
+
+        // Consumer pops from the tail; the tail is always an empty node.
+        node* tail;
+
+    public:
+
+        mpsc_queue() :
+            head{new node},
+            tail{head.load(std::memory_order_relaxed)}
+        {}
+
+
+        mpsc_queue(const mpsc_queue&) = delete;
+
+
+        ~mpsc_queue()
+            noexcept
+        {
+            while (pop())
+                ;
+            delete tail;
+        }
+
+
+        // Can be called from any thread.
+        void
+        push(T value)
+        {
+            node* n = new node;
+            n->value.emplace(std::move(value));
+            node* prev = head.exchange(n, std::memory_order_acq_rel);
+            prev->next.store(n, std::memory_order_release);
+        }
+
+
+        // Must only be called from one thread at a time.
+        std::optional<T>
+        pop()
+            noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            node* next = tail->next.load(std::memory_order_acquire);
+            if (!next)
+                return {};
+            std::optional<T> result{std::move(next->value)};
+            next->value.reset();
+            delete tail;
+            tail = next;
+            return result;
+        }
+
+
+        // Must only be called from the consumer thread.
+        [[nodiscard]]
+        bool
+        empty()
+            const noexcept
+        {
+            return !tail->next.load(std::memory_order_acquire);
+        }
+
+    }; // class mpsc_queue
+
+} // namespace curl::detail
+
+#endif
@@ -8,31 +8,126 @@
 #ifndef CURLXX_MULTI_HPP
 #define CURLXX_MULTI_HPP
 
+#include <chrono>
+#include <concepts>
 #include <cstddef>
 #include <expected>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <tuple>
 #include <vector>
 
 #include <curl/curl.h>
 
 #include "basic_wrapper.hpp"
+#include "easy.hpp"
 #include "error.hpp"
 
 
 namespace curl {
 
-    class easy;
+    class metrics_registry;
 
 
     struct multi : detail::basic_wrapper<CURLM*> {
 
+        /*--------------*/
+        /* Type aliases */
+        /*--------------*/
+
         using base_type = detail::basic_wrapper<CURLM*>;
 
 
+        // NOTE: ez is null for internal handles, that are not known by the wrapper.
+        using socket_callback_signature = int (easy* ez,
+                                               curl_socket_t s,
+                                               int what,
+                                               void* socket_data);
+
+        // NOTE: a negative timeout means the timer should be deleted.
+        using timer_callback_signature = int (std::chrono::milliseconds timeout);
+
+
+        // The headers of a server push request; only valid during the push callback.
+        class push_headers {
+
+            curl_pushheaders* raw;
+            std::size_t count;
+
+        public:
+
+            push_headers(curl_pushheaders* raw,
+                         std::size_t count)
+                noexcept;
+
+
+            [[nodiscard]]
+            std::size_t
+            size()
+                const noexcept;
+
+            // The whole header, as "name:value".
+            [[nodiscard]]
+            std::string_view
+            operator [](std::size_t index)
+                const noexcept;
+
+            // The value of a header, like ":path" or ":authority".
+            [[nodiscard]]
+            std::optional<std::string_view>
+            find(const char* name)
+                const noexcept;
+
+        }; // class push_headers
+
+
+        // NOTE: parent is null for internal handles, that are not known by the wrapper.
+        // Return true to accept the push.
+        using push_callback_signature = bool (easy* parent,
+                                              easy& pushed,
+                                              const push_headers& headers);
+
+
+#if CURL_AT_LEAST_VERSION(8, 17, 0)
+
+        // NOTE: ez is null for internal handles, and for notifications that are not about
+        // a single transfer.
+        using notify_callback_signature = void (unsigned notification,
+                                                easy* ez);
+
+        using notify_function_t = std::move_only_function<notify_callback_signature>;
+
+#endif // CURL_AT_LEAST_VERSION(8, 17, 0)
+
+        using push_function_t   = std::move_only_function<push_callback_signature>;
+        using socket_function_t = std::move_only_function<socket_callback_signature>;
+        using timer_function_t  = std::move_only_function<timer_callback_signature>;
+
+
+        struct extra_state_type {
+#if CURL_AT_LEAST_VERSION(8, 17, 0)
+            notify_function_t notify_func;
+#endif
+            push_function_t   push_func;
+            socket_function_t socket_func;
+            timer_function_t  timer_func;
+            std::shared_ptr<metrics_registry> metrics;
+            // Accepted server pushes, until they're taken.
+            std::vector<std::unique_ptr<easy>> pushed;
+        };
+
+        // combine base_type::state_type and extra_state_type
+        using state_type = std::tuple<base_type::state_type, extra_state_type>;
+
+
         /// Default constructor.
         multi();
 
         /// Empty constructor.
-        constexpr
+        inline
         multi(std::nullptr_t)
             noexcept
         {}
@@ -42,12 +137,12 @@ namespace curl {
 
         /// Move constructor.
         multi(multi&& other)
-            noexcept = default;
+            noexcept;
 
         /// Move assignment.
         multi&
         operator =(multi&& other)
-            noexcept = default;
+            noexcept;
 
         /// Destructor.
         ~multi()
@@ -66,6 +161,21 @@ namespace curl {
             noexcept override;
 
 
+        [[nodiscard]]
+        state_type
+        release()
+            noexcept;
+
+
+        void
+        acquire(state_type new_state)
+            noexcept;
+
+        void
+        acquire(raw_type new_raw)
+            noexcept;
+
+
         void
         add(easy& ez);
 
@@ -90,6 +200,83 @@ namespace curl {
             noexcept;
 
 
+        // Corresponds to curl_multi_socket_action()
+        // Returns the number of running handles.
+
+        unsigned
+        socket_action(curl_socket_t s = CURL_SOCKET_TIMEOUT,
+                      int ev_bitmask = 0);
+
+        std::expected<unsigned, error>
+        try_socket_action(curl_socket_t s = CURL_SOCKET_TIMEOUT,
+                          int ev_bitmask = 0)
+            noexcept;
+
+
+        // Corresponds to curl_multi_poll()
+        // Returns the number of file descriptors with activity.
+        // The timeout is clamped to [0, INT_MAX] milliseconds.
+        // Note: unlike wait(), this can be interrupted by wakeup().
+
+        unsigned
+        poll(std::chrono::milliseconds timeout,
+             std::span<curl_waitfd> extra_fds = {});
+
+        std::expected<unsigned, error>
+        try_poll(std::chrono::milliseconds timeout,
+                 std::span<curl_waitfd> extra_fds = {})
+            noexcept;
+
+
+        // Corresponds to curl_multi_wait()
+        // Returns the number of file descriptors with activity.
+        // The timeout is clamped to [0, INT_MAX] milliseconds.
+
+        unsigned
+        wait(std::chrono::milliseconds timeout,
+             std::span<curl_waitfd> extra_fds = {});
+
+        std::expected<unsigned, error>
+        try_wait(std::chrono::milliseconds timeout,
+                 std::span<curl_waitfd> extra_fds = {})
+            noexcept;
+
+
+        // Corresponds to curl_multi_wakeup()
+        // Makes a blocked poll() return; this is safe to call from another thread.
+
+        void
+        wakeup();
+
+        std::expected<void, error>
+        try_wakeup()
+            noexcept;
+
+
+        // Corresponds to curl_multi_assign()
+        // The socket_data pointer is passed back to the socket callback.
+
+        void
+        assign(curl_socket_t s,
+               void* socket_data);
+
+        std::expected<void, error>
+        try_assign(curl_socket_t s,
+                   void* socket_data)
+            noexcept;
+
+
+        // Corresponds to curl_multi_timeout()
+        // A negative value means there's no timeout set.
+
+        std::chrono::milliseconds
+        get_timeout();
+
+        std::expected<std::chrono::milliseconds, error>
+        try_get_timeout()
+            noexcept;
+
+
         struct msg_done {
             easy* handle;
             CURLcode result;
@@ -99,6 +286,42 @@ namespace curl {
         std::vector<msg_done>
         get_done();
 
+        // Same as above, but reuses the storage in result, which is cleared first.
+        void
+        get_done(std::vector<msg_done>& result);
+
+        // Read the next completed transfer, if any.
+        std::optional<msg_done>
+        next_done()
+            noexcept;
+
+        // Call visitor on each completed transfer, without storing them.
+        // Returns how many completed transfers were visited.
+        template<std::invocable<const msg_done&> Func>
+        unsigned
+        visit_done(Func&& visitor)
+        {
+            unsigned count = 0;
+            while (auto msg = next_done()) {
+                std::invoke(visitor, *msg);
+                ++count;
+            }
+            return count;
+        }
+
+
+        // Record every completed transfer in the registry, as it's read by next_done(),
+        // get_done() or visit_done().
+        // Note: a null pointer stops the recording.
+        void
+        set_metrics(std::shared_ptr<metrics_registry> registry)
+            noexcept;
+
+        [[nodiscard]]
+        const std::shared_ptr<metrics_registry>&
+        get_metrics()
+            const noexcept;
+
 
         /* ------------------------ */
         /* Start of option setters. */
@@ -164,11 +387,51 @@ namespace curl {
 #endif // CURL_AT_LEAST_VERSION(8, 16, 0)
 
 
+#if CURL_AT_LEAST_VERSION(8, 17, 0)
+
         // CURLMOPT_NOTIFYDATA
-        // Custom pointer passed to the notify callback. TODO
+        // Custom pointer passed to the notify callback.
+        // Note: not implemented, use a lambda with a capture for the notify function.
 
         // CURLMOPT_NOTIFYFUNCTION
-        // Callback that receives notifications. TODO
+        // Callback that receives notifications.
+        // Notifications must also be enabled with enable_notification(). For example,
+        // with CURLMNOTIFY_INFO_READ the event loop only needs to call get_done() after it
+        // was notified, instead of after every perform(). The callback should only take
+        // note of the event; it's called from inside libcurl.
+
+        void
+        set_notify_function(notify_function_t notify_func);
+
+        std::expected<void, error>
+        try_set_notify_function(notify_function_t notify_func)
+            noexcept;
+
+        void
+        unset_notify_function()
+            noexcept;
+
+
+        // Corresponds to curl_multi_notify_enable()
+
+        void
+        enable_notification(unsigned notification);
+
+        std::expected<void, error>
+        try_enable_notification(unsigned notification)
+            noexcept;
+
+
+        // Corresponds to curl_multi_notify_disable()
+
+        void
+        disable_notification(unsigned notification);
+
+        std::expected<void, error>
+        try_disable_notification(unsigned notification)
+            noexcept;
+
+#endif // CURL_AT_LEAST_VERSION(8, 17, 0)
 
 
         // CURLMOPT_PIPELINING
@@ -183,29 +446,144 @@ namespace curl {
 
 
         // CURLMOPT_PUSHDATA
-        // Pointer to pass to push callback. TODO
+        // Pointer to pass to push callback.
+        // Note: not implemented, use a lambda with a capture for the push function.
 
         // CURLMOPT_PUSHFUNCTION
-        // Callback that approves or denies server pushes. TODO
+        // Callback that approves or denies server pushes.
+        // Each pushed stream gets a new easy wrapper, set up like a copy of the parent
+        // (with its memory body setting, etc, but without its callbacks), which the push
+        // function can change before accepting it. Unless the push function sets another
+        // write target, the body is collected in memory (see easy::set_write_to_memory()).
+        // Accepted pushes are owned by this multi handle, and show up in get_done() when
+        // they complete; use take_pushed() to get them.
+        // Note: a pushed handle is kept, even after it completes, until take_pushed() is
+        // called for it or this multi handle is destroyed. A client that doesn't call
+        // take_pushed() for each completed push keeps every pushed handle alive.
+
+        void
+        set_push_function(push_function_t push_func);
+
+        std::expected<void, error>
+        try_set_push_function(push_function_t push_func)
+            noexcept;
+
+        void
+        unset_push_function()
+            noexcept;
+
 
         // CURLMOPT_SOCKETDATA
-        // Custom pointer passed to the socket callback. TODO
+        // Custom pointer passed to the socket callback.
+        // Note: not implemented, use a lambda with a capture for the socket function.
 
         // CURLMOPT_SOCKETFUNCTION
-        // Callback informed about what to wait for. TODO
+        // Callback informed about what to wait for.
+
+        void
+        set_socket_function(socket_function_t socket_func);
+
+        std::expected<void, error>
+        try_set_socket_function(socket_function_t socket_func)
+            noexcept;
+
+        void
+        unset_socket_function()
+            noexcept;
+
 
         // CURLMOPT_TIMERDATA
-        // Custom pointer to pass to timer callback. TODO
+        // Custom pointer to pass to timer callback.
+        // Note: not implemented, use a lambda with a capture for the timer function.
 
         // CURLMOPT_TIMERFUNCTION
-        // Callback to receive timeout values. TODO
+        // Callback to receive timeout values.
+
+        void
+        set_timer_function(timer_function_t timer_func);
+
+        std::expected<void, error>
+        try_set_timer_function(timer_function_t timer_func)
+            noexcept;
+
+        void
+        unset_timer_function()
+            noexcept;
 
 
         /* ---------------------- */
         /* End of option setters. */
         /* ---------------------- */
 
-    };
+
+        // Take a pushed transfer (see set_push_function()), removing it from this multi
+        // handle.
+        // Fails with CURLM_BAD_EASY_HANDLE if ez is not a pushed transfer owned by this.
+
+        easy
+        take_pushed(easy& ez);
+
+        std::expected<easy, error>
+        try_take_pushed(easy& ez)
+            noexcept;
+
+
+    private:
+
+        void
+        setup_extra_state()
+            noexcept;
+
+
+        /*------------------*/
+        /* Callback helpers */
+        /*------------------*/
+
+#if CURL_AT_LEAST_VERSION(8, 17, 0)
+
+        static
+        void
+        notify_callback_helper(CURLM* handle,
+                               unsigned notification,
+                               CURL* target,
+                               multi* m)
+            noexcept;
+
+#endif // CURL_AT_LEAST_VERSION(8, 17, 0)
+
+        static
+        int
+        push_callback_helper(CURL* parent,
+                             CURL* pushed,
+                             std::size_t num_headers,
+                             curl_pushheaders* headers,
+                             multi* m)
+            noexcept;
+
+        static
+        int
+        socket_callback_helper(CURL* handle,
+                               curl_socket_t s,
+                               int what,
+                               multi* m,
+                               void* socket_data)
+            noexcept;
+
+        static
+        int
+        timer_callback_helper(CURLM* handle,
+                              long timeout_ms,
+                              multi* m)
+            noexcept;
+
+
+        /*--------------*/
+        /* Private data */
+        /*--------------*/
+
+        extra_state_type extra_state;
+
+    }; // struct multi
 
 } // namespace curl
 
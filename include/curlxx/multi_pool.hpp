@@ -0,0 +1,130 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef CURLXX_MULTI_POOL_HPP
+#define CURLXX_MULTI_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "easy.hpp"
+#include "mpsc_queue.hpp"
+#include "multi.hpp"
+
+
+namespace curl {
+
+    // A pool of worker threads, each one driving its own multi handle (a "shard").
+    // Easy handles are submitted to a shard, and come back through a lock-free
+    // completion queue.
+    class multi_pool {
+
+    public:
+
+        using setup_function_t = std::move_only_function<void (multi& m)>;
+
+
+        struct completion {
+            easy handle;
+            CURLcode result;
+            std::size_t shard;
+        };
+
+
+        struct shard_stats {
+            std::uint64_t submitted = 0;
+            std::uint64_t completed = 0;
+            std::uint64_t failed = 0;
+            std::uint64_t wakeups = 0;
+            unsigned running = 0;
+        };
+
+
+    private:
+
+        struct shard;
+
+        std::vector<std::unique_ptr<shard>> shards;
+        std::atomic<std::size_t> next_shard = 0;
+
+        detail::mpsc_queue<completion> completions;
+        std::atomic<std::uint64_t> completions_pushed = 0;
+
+
+        void
+        push_completion(completion c);
+
+    public:
+
+        // Start num_shards worker threads (one per hardware thread, when zero).
+        // The optional setup function is called on each shard's multi handle, before the
+        // worker thread starts.
+        explicit
+        multi_pool(std::size_t num_shards = 0,
+                   setup_function_t setup = {});
+
+        // This object can't be moved, the worker threads refer to it.
+        multi_pool(const multi_pool&) = delete;
+
+        // Stop all the worker threads. Transfers still running are aborted, and their
+        // easy handles destroyed.
+        ~multi_pool()
+            noexcept;
+
+
+        // Submit to the shards in round-robin order.
+        // Returns the shard index.
+        std::size_t
+        submit(easy ez);
+
+        // Submit to the shard selected by key, so equal keys (for instance, a hash of the
+        // host name) always go to the same shard.
+        // Returns the shard index.
+        std::size_t
+        submit(easy ez,
+               std::size_t key);
+
+
+        // Take a completed transfer, if there's one available.
+        // Note: only one thread at a time may take completions.
+        std::optional<completion>
+        try_pop();
+
+        // Wait until a completed transfer is available.
+        // Note: only one thread at a time may take completions.
+        completion
+        pop();
+
+
+        [[nodiscard]]
+        std::size_t
+        size()
+            const noexcept;
+
+
+        [[nodiscard]]
+        shard_stats
+        get_stats(std::size_t index)
+            const noexcept;
+
+        [[nodiscard]]
+        std::vector<shard_stats>
+        get_stats()
+            const;
+
+    }; // class multi_pool
+
+} // namespace curl
+
+#endif
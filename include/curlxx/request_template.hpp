@@ -0,0 +1,67 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef CURLXX_REQUEST_TEMPLATE_HPP
+#define CURLXX_REQUEST_TEMPLATE_HPP
+
+#include <concepts>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include "easy.hpp"
+
+
+namespace curl {
+
+    // A configured easy handle, used as a prototype to stamp out many near-identical
+    // requests. Each request is a copy of the prototype: libcurl duplicates the options,
+    // the callbacks are shared, and the header lists and URL object are copied.
+    // To avoid copying the headers, use easy::set_http_headers() with a shared list.
+    // make() and configure() can be called from multiple threads. The requests share the
+    // prototype's callables (and statically bound objects, sinks and sources; see easy's
+    // copy constructor), so if they run on different threads, those must be safe to call
+    // concurrently; otherwise, set them on each request after make().
+    class request_template {
+
+        mutable std::mutex mutex;
+        easy prototype;
+
+    public:
+
+        request_template();
+
+        explicit
+        request_template(easy prototype);
+
+
+        // Change the prototype. Requests already made are not affected.
+        template<std::invocable<easy&> Func>
+        void
+        configure(Func&& func)
+        {
+            std::lock_guard guard{mutex};
+            std::invoke(std::forward<Func>(func), prototype);
+        }
+
+
+        [[nodiscard]]
+        easy
+        make()
+            const;
+
+        // Make a request for another URL.
+        [[nodiscard]]
+        easy
+        make(const std::string& url_str)
+            const;
+
+    }; // class request_template
+
+} // namespace curl
+
+#endif
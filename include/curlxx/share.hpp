@@ -0,0 +1,231 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef CURLXX_SHARE_HPP
+#define CURLXX_SHARE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <tuple>
+
+#include <curl/curl.h>
+
+#include "basic_wrapper.hpp"
+#include "error.hpp"
+
+
+namespace curl {
+
+    // Share handle, to share caches between easy handles.
+    // Note: the easy handles only hold a pointer to this, so it must outlive them.
+    struct share : detail::basic_wrapper<CURLSH*> {
+
+        /*--------------*/
+        /* Type aliases */
+        /*--------------*/
+
+        using base_type = detail::basic_wrapper<CURLSH*>;
+
+
+        // Data that can be shared.
+        enum class data_type : int {
+            cookie      = CURL_LOCK_DATA_COOKIE,
+            dns         = CURL_LOCK_DATA_DNS,
+            ssl_session = CURL_LOCK_DATA_SSL_SESSION,
+            connect     = CURL_LOCK_DATA_CONNECT,
+            psl         = CURL_LOCK_DATA_PSL,
+#if CURL_AT_LEAST_VERSION(7, 88, 0)
+            hsts        = CURL_LOCK_DATA_HSTS,
+#endif
+        };
+
+
+        // Built-in locking, needed when the easy handles are used from multiple threads.
+        enum class locking {
+            none,         // No locking.
+            mutex,        // One std::mutex for each kind of data.
+            shared_mutex, // One std::shared_mutex for each kind of data, shared access is
+                          // used when libcurl asks for it.
+        };
+
+
+        struct lock_table {
+            locking mode = locking::none;
+            std::array<std::mutex, CURL_LOCK_DATA_LAST> mutexes;
+            std::array<std::shared_mutex, CURL_LOCK_DATA_LAST> shared_mutexes;
+            // Which thread holds the exclusive lock, to know how to unlock a shared_mutex.
+            std::array<std::atomic<std::thread::id>, CURL_LOCK_DATA_LAST> writers;
+        };
+
+        using state_type = std::tuple<base_type::state_type, std::unique_ptr<lock_table>>;
+
+
+        /// Default constructor.
+        share();
+
+        /// Create a share handle with the built-in locking.
+        explicit
+        share(locking mode);
+
+        /// Empty constructor.
+        inline
+        share(std::nullptr_t)
+            noexcept
+        {}
+
+        explicit
+        share(CURLSH* handle);
+
+        /// Move constructor.
+        share(share&& other)
+            noexcept;
+
+        /// Move assignment.
+        share&
+        operator =(share&& other)
+            noexcept;
+
+        /// Destructor.
+        ~share()
+            noexcept;
+
+
+        void
+        create();
+
+        void
+        create(CURLSH* handle);
+
+
+        void
+        destroy()
+            noexcept override;
+
+
+        [[nodiscard]]
+        state_type
+        release()
+            noexcept;
+
+
+        void
+        acquire(state_type new_state)
+            noexcept;
+
+        void
+        acquire(raw_type new_raw)
+            noexcept;
+
+
+        /* ------------------------ */
+        /* Start of option setters. */
+        /* ------------------------ */
+
+
+        // CURLSHOPT_LOCKFUNC
+        // CURLSHOPT_UNLOCKFUNC
+        // CURLSHOPT_USERDATA
+        // Set up the built-in locking.
+        // Note: this must be done before the share handle is used by any easy handle.
+
+        void
+        set_locking(locking mode);
+
+        std::expected<void, error>
+        try_set_locking(locking mode)
+            noexcept;
+
+
+        // CURLSHOPT_SHARE
+        // Start sharing some data.
+
+        void
+        set_share(data_type d);
+
+        std::expected<void, error>
+        try_set_share(data_type d)
+            noexcept;
+
+
+        // CURLSHOPT_UNSHARE
+        // Stop sharing some data.
+
+        void
+        set_unshare(data_type d);
+
+        std::expected<void, error>
+        try_set_unshare(data_type d)
+            noexcept;
+
+
+        /* ---------------------- */
+        /* End of option setters. */
+        /* ---------------------- */
+
+
+    private:
+
+        // Point USERDATA, LOCKFUNC and UNLOCKFUNC to table, using its mode; a null table
+        // removes the lock functions.
+        std::expected<void, error>
+        try_install_locks(lock_table* table)
+            noexcept;
+
+
+        /*------------------*/
+        /* Callback helpers */
+        /*------------------*/
+
+        static
+        void
+        mutex_lock_helper(CURL* handle,
+                          curl_lock_data d,
+                          curl_lock_access access,
+                          lock_table* table)
+            noexcept;
+
+        static
+        void
+        mutex_unlock_helper(CURL* handle,
+                            curl_lock_data d,
+                            lock_table* table)
+            noexcept;
+
+        static
+        void
+        shared_mutex_lock_helper(CURL* handle,
+                                 curl_lock_data d,
+                                 curl_lock_access access,
+                                 lock_table* table)
+            noexcept;
+
+        static
+        void
+        shared_mutex_unlock_helper(CURL* handle,
+                                   curl_lock_data d,
+                                   lock_table* table)
+            noexcept;
+
+
+        /*--------------*/
+        /* Private data */
+        /*--------------*/
+
+        // Note: the lock table is heap-allocated, so it doesn't move with the wrapper.
+        std::unique_ptr<lock_table> locks;
+
+    }; // struct share
+
+} // namespace curl
+
+#endif
@@ -0,0 +1,194 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef CURLXX_SINK_HPP
+#define CURLXX_SINK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <system_error>
+
+#include <curl/curl.h>
+
+
+namespace curl {
+
+    // Sinks receive the response body directly, without a type-erased write function.
+    // Use them with easy::set_write_sink(). A sink must have a write() member that takes a
+    // std::span<const char> and returns the amount of bytes consumed; it can also have a
+    // start(CURL*) member, that is called before the first write of each transfer, with
+    // the handle doing the transfer.
+    // Note: sinks are not owned by the easy handle, they must outlive the transfer.
+
+
+    // Appends into a caller-owned contiguous container (std::string, std::vector<char>,
+    // std::vector<std::byte>, ...).
+    // Before the first write of each transfer, the container's capacity is reserved from
+    // the Content-Length, so the body is not reallocated while it grows. The reservation
+    // is capped by max_reserve, so a bogus Content-Length can't exhaust the memory.
+    template<typename Container = std::string>
+    class buffer_sink {
+
+        static_assert(sizeof(typename Container::value_type) == 1,
+                      "buffer_sink needs a container of bytes");
+
+        Container* dest;
+        std::size_t max_reserve;
+
+    public:
+
+        static constexpr std::size_t default_max_reserve = 64 * 1024 * 1024;
+
+
+        explicit
+        buffer_sink(Container& dest,
+                    std::size_t max_reserve = default_max_reserve)
+            noexcept :
+            dest{&dest},
+            max_reserve{max_reserve}
+        {}
+
+
+        void
+        start(CURL* handle)
+        {
+            curl_off_t length = -1;
+            if (curl_easy_getinfo(handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length)
+                != CURLE_OK)
+                return;
+            if (length <= 0)
+                return;
+            std::size_t amount = static_cast<std::uint64_t>(length) < max_reserve
+                ? static_cast<std::size_t>(length)
+                : max_reserve;
+            dest->reserve(dest->size() + amount);
+        }
+
+
+        std::size_t
+        write(std::span<const char> data)
+        {
+            auto first = reinterpret_cast<const typename Container::value_type*>(data.data());
+            dest->insert(dest->end(), first, first + data.size());
+            return data.size();
+        }
+
+
+        [[nodiscard]]
+        Container&
+        get_buffer()
+            const noexcept
+        {
+            return *dest;
+        }
+
+    }; // class buffer_sink
+
+
+    // Writes into a fixed, caller-provided buffer.
+    // If the body doesn't fit, the transfer fails with CURLE_WRITE_ERROR, and
+    // is_overflowed() returns true.
+    class span_sink {
+
+        std::span<std::byte> dest;
+        std::size_t written = 0;
+        bool overflowed = false;
+
+    public:
+
+        explicit
+        span_sink(std::span<std::byte> dest)
+            noexcept;
+
+
+        std::size_t
+        write(std::span<const char> data)
+            noexcept;
+
+
+        // Start writing at the beginning of the buffer again.
+        void
+        rewind()
+            noexcept;
+
+
+        // The part of the buffer that was written to.
+        [[nodiscard]]
+        std::span<std::byte>
+        get_data()
+            const noexcept;
+
+
+        [[nodiscard]]
+        std::size_t
+        get_written()
+            const noexcept;
+
+
+        [[nodiscard]]
+        bool
+        is_overflowed()
+            const noexcept;
+
+    }; // class span_sink
+
+
+    // Writes straight to a file descriptor, so the body never goes through a
+    // user-space buffer.
+    // If an offset is given, pwrite() is used starting at that offset, and the file
+    // position is not changed; otherwise write() is used.
+    // If writing fails, the transfer fails with CURLE_WRITE_ERROR, and get_error() reports
+    // the reason.
+    // Note: the file descriptor is not owned by the sink.
+    class fd_sink {
+
+        int fd;
+        std::int64_t offset;
+        bool positional;
+        std::error_code last_error;
+
+    public:
+
+        explicit
+        fd_sink(int fd)
+            noexcept;
+
+        fd_sink(int fd,
+                std::int64_t offset)
+            noexcept;
+
+
+        std::size_t
+        write(std::span<const char> data)
+            noexcept;
+
+
+        [[nodiscard]]
+        int
+        get_fd()
+            const noexcept;
+
+
+        // The offset where the next pwrite() happens.
+        [[nodiscard]]
+        std::int64_t
+        get_offset()
+            const noexcept;
+
+
+        [[nodiscard]]
+        std::error_code
+        get_error()
+            const noexcept;
+
+    }; // class fd_sink
+
+} // namespace curl
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef CURLXX_SOURCE_HPP
+#define CURLXX_SOURCE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+#include <curl/curl.h>
+
+
+namespace curl {
+
+    // Sources provide the upload body directly, without a type-erased read function.
+    // Use them with easy::set_read_source(). A source must have these members:
+    //   - std::size_t read(std::span<char> buffer): fill the buffer, return how many
+    //     bytes were written, 0 at the end.
+    //   - int seek(curl_off_t offset, int origin): like fseek(), returns one of the
+    //     CURL_SEEKFUNC_* constants; libcurl uses it to rewind for redirects and
+    //     multi-pass authentication.
+    //   - curl_off_t size() const: the total size, or -1 if unknown.
+    // Note: sources are not owned by the easy handle, they must outlive the transfer.
+
+
+    // Uploads a block of memory.
+    // Note: the memory is not copied.
+    class memory_source {
+
+        std::span<const std::byte> data;
+        std::size_t position = 0;
+
+    public:
+
+        explicit
+        memory_source(std::span<const std::byte> data)
+            noexcept;
+
+        explicit
+        memory_source(std::string_view data)
+            noexcept;
+
+
+        std::size_t
+        read(std::span<char> buffer)
+            noexcept;
+
+        int
+        seek(curl_off_t offset,
+             int origin)
+            noexcept;
+
+        [[nodiscard]]
+        curl_off_t
+        size()
+            const noexcept;
+
+    }; // class memory_source
+
+
+    // Uploads a memory-mapped file.
+    // Throws std::system_error if the file can't be opened or mapped.
+    class mmap_source {
+
+        const std::byte* data = nullptr;
+        std::size_t length = 0;
+        std::size_t position = 0;
+
+
+        void
+        map(int fd);
+
+        void
+        unmap()
+            noexcept;
+
+    public:
+
+        explicit
+        mmap_source(const std::filesystem::path& filename);
+
+        // Note: the file descriptor can be closed after this, the mapping stays valid.
+        explicit
+        mmap_source(int fd);
+
+        mmap_source(mmap_source&& other)
+            noexcept;
+
+        ~mmap_source()
+            noexcept;
+
+
+        mmap_source&
+        operator =(mmap_source&& other)
+            noexcept;
+
+
+        std::size_t
+        read(std::span<char> buffer)
+            noexcept;
+
+        int
+        seek(curl_off_t offset,
+             int origin)
+            noexcept;
+
+        [[nodiscard]]
+        curl_off_t
+        size()
+            const noexcept;
+
+    }; // class mmap_source
+
+
+    // Uploads from a file descriptor, using pread(), so the file position is not changed
+    // and the same file can be uploaded by multiple handles at once.
+    // If length is negative, everything from offset to the end of the file is uploaded.
+    // Throws std::system_error if the file size can't be determined.
+    // Note: the file descriptor is not owned by the source.
+    class fd_source {
+
+        int fd;
+        std::int64_t start;
+        std::int64_t length;
+        std::int64_t position = 0;
+
+    public:
+
+        explicit
+        fd_source(int fd,
+                  std::int64_t offset = 0,
+                  std::int64_t length = -1);
+
+
+        std::size_t
+        read(std::span<char> buffer)
+            noexcept;
+
+        int
+        seek(curl_off_t offset,
+             int origin)
+            noexcept;
+
+        [[nodiscard]]
+        curl_off_t
+        size()
+            const noexcept;
+
+    }; // class fd_source
+
+
+    // Uploads a sequence of memory segments, one after another, without coalescing them
+    // into a single buffer.
+    // Note: neither the segments, nor the memory they refer to, are copied.
+    class gather_source {
+
+        std::span<const std::span<const std::byte>> segments;
+        std::size_t total = 0;
+        // Current position: which segment, and where inside it.
+        std::size_t segment = 0;
+        std::size_t inner = 0;
+        std::size_t position = 0;
+
+    public:
+
+        explicit
+        gather_source(std::span<const std::span<const std::byte>> segments)
+            noexcept;
+
+
+        std::size_t
+        read(std::span<char> buffer)
+            noexcept;
+
+        int
+        seek(curl_off_t offset,
+             int origin)
+            noexcept;
+
+        [[nodiscard]]
+        curl_off_t
+        size()
+            const noexcept;
+
+    }; // class gather_source
+
+} // namespace curl
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef CURLXX_TRACE_HPP
+#define CURLXX_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+namespace curl {
+
+    // connect_start, connected, connection_reused and tls_done are not seen as they
+    // happen: they're recorded when the transfer is done, with their times taken from
+    // libcurl's timing info (see easy::transfer_stats). When redirects were followed,
+    // libcurl adds up the times of all requests, so these are only approximate.
+    enum class trace_event : std::uint8_t {
+        resolve_start,
+        connect_start,
+        connected,
+        connection_reused,
+        tls_done,
+        header_out,         // arg is the size of the request headers
+        header_in,          // arg is the size of one response header line
+        first_byte,
+        done,               // arg is the CURLcode
+    };
+
+
+    [[nodiscard]]
+    std::string_view
+    to_string(trace_event event)
+        noexcept;
+
+
+    struct trace_record {
+        std::chrono::nanoseconds time{}; // steady_clock's time since epoch
+        std::uint64_t transfer = 0;
+        std::uint32_t arg = 0;
+        std::uint16_t thread = 0;        // index of the recording thread in the tracer;
+                                         // wraps around after 65536 threads
+        trace_event event{};
+    };
+
+
+    // Collects timestamped events from transfers, with little overhead: each thread
+    // records into its own fixed-size ring buffer, without locks, and the oldest events
+    // are overwritten when it's full.
+    // Use it with easy::set_tracer(); the events come from the debug callback, so unlike
+    // set_verbose(true), nothing is formatted or written to a stream.
+    //
+    // Sampling is per transfer: with a sample period of N, only one in N transfers is
+    // traced, and the others have almost no cost. A period of 0 disables tracing.
+    class tracer {
+
+        struct ring;
+
+        const std::uint64_t id;
+        const std::size_t capacity;
+        std::atomic<unsigned> sample_period;
+        std::atomic<std::uint64_t> transfer_counter = 0;
+
+        // Only protects the list; the rings themselves are lock-free.
+        mutable std::mutex mutex;
+        std::vector<std::unique_ptr<ring>> rings;
+        // Each thread only ever gets one ring.
+        std::unordered_map<std::thread::id, ring*> thread_rings;
+
+
+        ring*
+        get_ring();
+
+    public:
+
+        // Each thread gets capacity events (rounded up to a power of two).
+        explicit
+        tracer(std::size_t capacity = 4096,
+               unsigned sample_period = 1);
+
+        tracer(const tracer&) = delete;
+
+        ~tracer()
+            noexcept;
+
+
+        void
+        set_sample_period(unsigned period)
+            noexcept;
+
+        [[nodiscard]]
+        unsigned
+        get_sample_period()
+            const noexcept;
+
+
+        // Returns an id for a new transfer, or zero if it was not sampled.
+        [[nodiscard]]
+        std::uint64_t
+        start_transfer()
+            noexcept;
+
+
+        // Does nothing if transfer is zero. Events are dropped if there's no memory for
+        // the calling thread's buffer.
+        void
+        record(std::uint64_t transfer,
+               trace_event event,
+               std::uint32_t arg = 0)
+            noexcept;
+
+        // Same, for an event that happened at another time.
+        void
+        record(std::chrono::steady_clock::time_point time,
+               std::uint64_t transfer,
+               trace_event event,
+               std::uint32_t arg = 0)
+            noexcept;
+
+
+        // Returns a copy of the events from all threads, sorted by time. This can be
+        // called while other threads are recording.
+        [[nodiscard]]
+        std::vector<trace_record>
+        collect()
+            const;
+
+    }; // class tracer
+
+
+    // Binary dump format, little-endian: the header is the magic "curlxxtr", a u32
+    // version (1), a u32 record size (24) and a u64 record count; each record is the
+    // time (u64), transfer (u64), arg (u32), thread (u16), event (u8) and a padding byte.
+
+    [[nodiscard]]
+    std::vector<std::byte>
+    write_trace_dump(std::span<const trace_record> records);
+
+    // Throws curl::error if the dump is not valid.
+    [[nodiscard]]
+    std::vector<trace_record>
+    read_trace_dump(std::span<const std::byte> dump);
+
+} // namespace curl
+
+#endif
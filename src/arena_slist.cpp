@@ -0,0 +1,160 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "curlxx/arena_slist.hpp"
+
+
+namespace curl {
+
+    arena_slist::arena_slist(std::initializer_list<std::string_view> values) :
+        arena_slist{std::views::all(values)}
+    {}
+
+
+    arena_slist::arena_slist(const arena_slist& other)
+    {
+        std::size_t total_chars = 0;
+        for (std::string_view str : other)
+            total_chars += str.size();
+        allocate(other.count, total_chars);
+        for (std::string_view str : other)
+            push(str);
+    }
+
+
+    arena_slist::arena_slist(arena_slist&& other)
+        noexcept :
+        storage{std::move(other.storage)},
+        head{std::exchange(other.head, nullptr)},
+        tail{std::exchange(other.tail, nullptr)},
+        next_char{std::exchange(other.next_char, nullptr)},
+        count{std::exchange(other.count, 0)}
+    {}
+
+
+    arena_slist&
+    arena_slist::operator =(const arena_slist& other)
+    {
+        if (this != &other)
+            *this = arena_slist{other};
+        return *this;
+    }
+
+
+    arena_slist&
+    arena_slist::operator =(arena_slist&& other)
+        noexcept
+    {
+        if (this != &other) {
+            storage   = std::move(other.storage);
+            head      = std::exchange(other.head, nullptr);
+            tail      = std::exchange(other.tail, nullptr);
+            next_char = std::exchange(other.next_char, nullptr);
+            count     = std::exchange(other.count, 0);
+        }
+        return *this;
+    }
+
+
+    void
+    arena_slist::allocate(std::size_t num_entries,
+                          std::size_t total_chars)
+    {
+        storage.reset();
+        head = tail = nullptr;
+        next_char = nullptr;
+        count = 0;
+        if (!num_entries)
+            return;
+
+        // Nodes first, to keep them aligned; the characters go after them.
+        std::size_t nodes_size = num_entries * sizeof(curl_slist);
+        storage = std::make_unique_for_overwrite<std::byte[]>(nodes_size
+                                                              + total_chars
+                                                              + num_entries);
+        next_char = reinterpret_cast<char*>(storage.get() + nodes_size);
+    }
+
+
+    void
+    arena_slist::push(std::string_view str)
+        noexcept
+    {
+        std::byte* slot = storage.get() + count++ * sizeof(curl_slist);
+
+        std::memcpy(next_char, str.data(), str.size());
+        next_char[str.size()] = '\0';
+        curl_slist* node = new (slot) curl_slist{next_char, nullptr};
+        next_char += str.size() + 1;
+
+        if (tail)
+            tail->next = node;
+        else
+            head = node;
+        tail = node;
+    }
+
+
+    const curl_slist*
+    arena_slist::data()
+        const noexcept
+    {
+        return head;
+    }
+
+
+    curl_slist*
+    arena_slist::data()
+        noexcept
+    {
+        return head;
+    }
+
+
+    arena_slist::const_iterator
+    arena_slist::begin()
+        const noexcept
+    {
+        return const_iterator{head};
+    }
+
+
+    arena_slist::const_iterator
+    arena_slist::end()
+        const noexcept
+    {
+        return {};
+    }
+
+
+    arena_slist::size_type
+    arena_slist::size()
+        const noexcept
+    {
+        return count;
+    }
+
+
+    bool
+    arena_slist::empty()
+        const noexcept
+    {
+        return !head;
+    }
+
+
+    arena_slist::operator bool()
+        const noexcept
+    {
+        return head;
+    }
+
+} // namespace curl
@@ -0,0 +1,184 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include <new>
+#include <tuple>
+#include <utility>
+
+#include "curlxx/coroutine.hpp"
+
+#include "curlxx/easy.hpp"
+
+
+namespace curl {
+
+    transfer::transfer(easy& ez,
+                       void* context,
+                       register_function_t* on_suspend)
+        noexcept :
+        ez{&ez},
+        context{context},
+        on_suspend{on_suspend}
+    {}
+
+
+    easy&
+    transfer::get_easy()
+        const noexcept
+    {
+        return *ez;
+    }
+
+
+    void
+    transfer::complete(CURLcode code)
+        noexcept
+    {
+        if (code != CURLE_OK)
+            result = std::unexpected{error{code}};
+        if (waiter)
+            std::exchange(waiter, {}).resume();
+    }
+
+
+    void
+    transfer::abandon()
+        noexcept
+    {
+        // Note: this object lives in the coroutine frame, so it's gone after this.
+        if (auto h = std::exchange(waiter, {}))
+            h.destroy();
+    }
+
+
+    bool
+    transfer::await_ready()
+        const noexcept
+    {
+        return false;
+    }
+
+
+    bool
+    transfer::await_suspend(std::coroutine_handle<> h)
+        noexcept
+    {
+        waiter = h;
+        auto status = on_suspend(context, *this);
+        if (!status) {
+            waiter = {};
+            result = std::unexpected{std::move(status.error())};
+            return false;
+        }
+        return true;
+    }
+
+
+    std::expected<void, error>
+    transfer::await_resume()
+        noexcept
+    {
+        return std::move(result);
+    }
+
+
+    client::client() = default;
+
+
+    client::~client()
+        noexcept
+    {
+        auto old_pending = std::move(pending);
+        pending.clear();
+        for (auto [ez, t] : old_pending) {
+            std::ignore = multi_handle.try_remove(*ez);
+            t->abandon();
+        }
+    }
+
+
+    multi&
+    client::get_multi()
+        noexcept
+    {
+        return multi_handle;
+    }
+
+
+    transfer
+    client::fetch(easy& ez)
+        noexcept
+    {
+        return transfer{ez, this, &start};
+    }
+
+
+    std::expected<void, error>
+    client::start(void* context,
+                  transfer& t)
+        noexcept
+    {
+        auto self = static_cast<client*>(context);
+        easy* ez = &t.get_easy();
+        try {
+            // Don't touch the entry of a transfer that's already using this handle.
+            if (!self->pending.emplace(ez, &t).second)
+                return std::unexpected{error{CURLM_ADDED_ALREADY}};
+        }
+        catch (std::bad_alloc&) {
+            return std::unexpected{error{CURLE_OUT_OF_MEMORY}};
+        }
+        auto status = self->multi_handle.try_add(*ez);
+        if (!status)
+            self->pending.erase(ez);
+        return status;
+    }
+
+
+    void
+    client::dispatch_done()
+    {
+        multi_handle.visit_done([this](const multi::msg_done& msg)
+        {
+            auto it = pending.find(msg.handle);
+            if (it == pending.end())
+                return;
+            transfer* t = it->second;
+            pending.erase(it);
+            std::ignore = multi_handle.try_remove(*msg.handle);
+            // Note: the coroutine may start new transfers before returning here.
+            t->complete(msg.result);
+        });
+    }
+
+
+    std::size_t
+    client::run_once(std::chrono::milliseconds timeout)
+    {
+        if (multi_handle.perform())
+            multi_handle.poll(timeout);
+        dispatch_done();
+        return pending.size();
+    }
+
+
+    void
+    client::run()
+    {
+        while (run_once())
+            ;
+    }
+
+
+    std::size_t
+    client::get_pending()
+        const noexcept
+    {
+        return pending.size();
+    }
+
+} // namespace curl
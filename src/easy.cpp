@@ -5,10 +5,14 @@
  * SPDX-License-Identifier: LGPL-3.0-or-later
  */
 
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <utility>
 
 #include "curlxx/easy.hpp"
 
+#include "curlxx/trace.hpp"
 #include "utils.hpp"
 
 
@@ -56,6 +60,43 @@ namespace curl {
             noexcept;
 
 
+        template<typename T,
+                 typename U>
+        void
+        getinfo_into(CURL* raw,
+                     CURLINFO info,
+                     U& dest,
+                     CURLcode& status)
+            noexcept;
+
+
+        bool
+        starts_with_icase(std::string_view str,
+                          std::string_view prefix)
+            noexcept;
+
+
+        void
+        watch_content_length(easy::memory_body_type& body,
+                             std::string_view line)
+            noexcept;
+
+
+        template<typename F>
+        std::shared_ptr<F>
+        share_function(F&& func)
+            noexcept;
+
+
+        easy::extra_state_type
+        clone_extra_state(const easy::extra_state_type& src);
+
+
+        std::shared_ptr<arena_slist>
+        share_list(arena_slist&& list)
+            noexcept;
+
+
         /*----------------------*/
         /* Function definitions */
         /*----------------------*/
@@ -123,6 +164,143 @@ namespace curl {
             return {};
         }
 
+
+        // Accumulating version, for reading many values at once; does nothing once
+        // status holds an error.
+        template<typename T,
+                 typename U>
+        void
+        getinfo_into(CURL* raw,
+                     CURLINFO info,
+                     U& dest,
+                     CURLcode& status)
+            noexcept
+        {
+            if (status)
+                return;
+            T result;
+            status = curl_easy_getinfo(raw, info, &result);
+            if (!status)
+                dest = static_cast<U>(result);
+        }
+
+
+        bool
+        starts_with_icase(std::string_view str,
+                          std::string_view prefix)
+            noexcept
+        {
+            if (str.size() < prefix.size())
+                return false;
+            for (std::size_t i = 0; i < prefix.size(); ++i) {
+                unsigned char a = str[i];
+                unsigned char b = prefix[i];
+                if (std::tolower(a) != std::tolower(b))
+                    return false;
+            }
+            return true;
+        }
+
+
+        // Look at one header line, to find out how big the body will be.
+        void
+        watch_content_length(easy::memory_body_type& body,
+                             std::string_view line)
+            noexcept
+        {
+            if (line.starts_with("HTTP/")) {
+                // A new response is starting, within the same transfer (after a redirect,
+                // a 1xx, or an authentication retry); start_transfer() resets the rest.
+                body.data.clear();
+                body.expected = -1;
+                body.reserved = false;
+                return;
+            }
+
+            constexpr std::string_view name = "content-length:";
+            if (!starts_with_icase(line, name))
+                return;
+            line.remove_prefix(name.size());
+            while (!line.empty() && (line.front() == ' ' || line.front() == '\t'))
+                line.remove_prefix(1);
+            curl_off_t length = -1;
+            auto [ptr, ec] = std::from_chars(line.data(), line.data() + line.size(), length);
+            if (ec == std::errc{} && length >= 0)
+                body.expected = length;
+        }
+
+
+        // Move the function into shared storage; returns null if out of memory.
+        template<typename F>
+        std::shared_ptr<F>
+        share_function(F&& func)
+            noexcept
+        {
+            try {
+                return std::make_shared<F>(std::move(func));
+            }
+            catch (...) {
+                return {};
+            }
+        }
+
+
+        // Move the list into shared storage; returns null if out of memory.
+        std::shared_ptr<arena_slist>
+        share_list(arena_slist&& list)
+            noexcept
+        {
+            try {
+                return std::make_shared<arena_slist>(std::move(list));
+            }
+            catch (...) {
+                return {};
+            }
+        }
+
+
+        // Copy everything that's meaningful to a copy of the handle: callbacks (and the
+        // objects bound statically) are shared, lists and URL are deep-copied.
+        easy::extra_state_type
+        clone_extra_state(const easy::extra_state_type& src)
+        {
+            easy::extra_state_type result;
+
+            result.closesocket_func = src.closesocket_func;
+            result.debug_func       = src.debug_func;
+            result.fnmatch_func     = src.fnmatch_func;
+            result.header_func      = src.header_func;
+            result.opensocket_func  = src.opensocket_func;
+            result.progress_func    = src.progress_func;
+            result.read_func        = src.read_func;
+            result.seek_func        = src.seek_func;
+            result.write_func       = src.write_func;
+            result.write_sink       = src.write_sink;
+
+            result.header_bound_statically   = src.header_bound_statically;
+            result.progress_bound_statically = src.progress_bound_statically;
+            result.read_bound_statically     = src.read_bound_statically;
+            result.seek_bound_statically     = src.seek_bound_statically;
+            result.write_bound_statically    = src.write_bound_statically;
+
+            // Keep the configuration, but not the body.
+            result.memory_body.enabled     = src.memory_body.enabled;
+            result.memory_body.max_reserve = src.memory_body.max_reserve;
+
+            if (src.http_headers_list)
+                result.http_headers_list = slist{src.http_headers_list};
+            result.shared_http_headers = src.shared_http_headers;
+            if (src.connect_to_list)
+                result.connect_to_list = slist{src.connect_to_list};
+            result.shared_connect_to = src.shared_connect_to;
+            if (src.url_obj)
+                result.url_obj = url{src.url_obj};
+            result.private_data = src.private_data;
+            result.trace_sink = src.trace_sink;
+
+            return result;
+        }
+
     } // namespace
 
 
@@ -211,12 +389,19 @@ namespace curl {
             return;
         }
 
+        auto new_state = clone_extra_state(other.extra_state);
+
         auto new_raw = curl_easy_duphandle(other.raw);
         if (!new_raw)
             throw error{"curl_easy_duphandle() failed"};
 
         destroy();
-        acquire(new_raw);
+        // Note: setup_extra_state() will point the duplicated options to the new state.
+        acquire(state_type{new_raw, std::move(new_state)});
+        // The copy's transfers are traced separately.
+        if (extra_state.trace_sink)
+            start_trace();
+
     }
 
 
@@ -267,7 +452,10 @@ namespace curl {
     {
         if (raw) {
             curl_easy_reset(raw);
+            // Keep the error buffer storage, so reusing a handle doesn't allocate it again.
+            auto old_error_buffer = std::move(extra_state.error_buffer);
             extra_state = {};
+            extra_state.error_buffer = std::move(old_error_buffer);
             setup_extra_state();
         }
     }
@@ -316,7 +504,9 @@ namespace curl {
     easy::try_perform()
         noexcept
     {
+        start_transfer();
         auto e = curl_easy_perform(raw);
+        finish_transfer(e);
         if (e != CURLE_OK)
             return std::unexpected{error{e}};
         return {};
@@ -662,13 +852,17 @@ namespace curl {
             return {};
         }
 
-        auto data_status = wrap_setopt(raw, CURLOPT_CLOSESOCKETDATA, raw);
+        auto shared_func = share_function(std::move(closesocket_func));
+        if (!shared_func)
+            return std::unexpected{error{CURLE_OUT_OF_MEMORY}};
+
+        auto data_status = wrap_setopt(raw, CURLOPT_CLOSESOCKETDATA, this);
         if (!data_status)
             return data_status;
         auto func_status = wrap_setopt(raw, CURLOPT_CLOSESOCKETFUNCTION, &closesocket_callback_helper);
         if (!func_status)
             return func_status;
-        extra_state.closesocket_func = std::move(closesocket_func);
+        extra_state.closesocket_func = std::move(shared_func);
         return {};
     }
 
@@ -740,8 +934,33 @@ namespace curl {
         noexcept
     {
         auto result = wrap_setopt(raw, CURLOPT_CONNECT_TO, hosts.data());
-        if (result)
+        if (result) {
             extra_state.connect_to_list = std::move(hosts);
+            extra_state.shared_connect_to.reset();
+        }
+        return result;
+    }
+
+
+    void
+    easy::set_connect_to(arena_slist hosts)
+    {
+        return value_or_throw(try_set_connect_to(std::move(hosts)));
+    }
+
+
+    std::expected<void, error>
+    easy::try_set_connect_to(arena_slist hosts)
+        noexcept
+    {
+        auto owner = share_list(std::move(hosts));
+        if (!owner)
+            return std::unexpected{error{CURLE_OUT_OF_MEMORY}};
+        auto result = wrap_setopt(raw, CURLOPT_CONNECT_TO, owner->data());
+        if (result) {
+            extra_state.shared_connect_to = {owner, owner->data()};
+            extra_state.connect_to_list.destroy();
+        }
         return result;
     }
 
@@ -998,13 +1217,17 @@ namespace curl {
             return {};
         }
 
-        auto data_status = wrap_setopt(raw, CURLOPT_DEBUGDATA, raw);
+        auto shared_func = share_function(std::move(debug_func));
+        if (!shared_func)
+            return std::unexpected{error{CURLE_OUT_OF_MEMORY}};
+
+        auto data_status = wrap_setopt(raw, CURLOPT_DEBUGDATA, this);
         if (!data_status)
             return data_status;
         auto func_status = wrap_setopt(raw, CURLOPT_DEBUGFUNCTION, &debug_callback_helper);
         if (!func_status)
             return func_status;
-        extra_state.debug_func = std::move(debug_func);
+        extra_state.debug_func = std::move(shared_func);
         return {};
     }
 
@@ -1014,11 +1237,72 @@ namespace curl {
         noexcept
     {
         extra_state.debug_func = {};
+        // The tracer still needs the debug callback.
+        if (extra_state.trace_sink) {
+            curl_easy_setopt(raw, CURLOPT_VERBOSE, long{extra_state.trace_transfer != 0});
+            return;
+        }
         wrap_unsetopt(raw, CURLOPT_DEBUGDATA);
         wrap_unsetopt(raw, CURLOPT_DEBUGFUNCTION);
     }
 
 
+    void
+    easy::set_tracer(std::shared_ptr<tracer> t)
+    {
+        return value_or_throw(try_set_tracer(std::move(t)));
+    }
+
+
+    std::expected<void, error>
+    easy::try_set_tracer(std::shared_ptr<tracer> t)
+        noexcept
+    {
+        if (!t) {
+            unset_tracer();
+            return {};
+        }
+
+        auto debug_data_status = wrap_setopt(raw, CURLOPT_DEBUGDATA, this);
+        if (!debug_data_status)
+            return debug_data_status;
+        auto debug_func_status = wrap_setopt(raw,
+                                             CURLOPT_DEBUGFUNCTION,
+                                             &debug_callback_helper);
+        if (!debug_func_status)
+            return debug_func_status;
+        auto resolver_data_status = wrap_setopt(raw, CURLOPT_RESOLVER_START_DATA, this);
+        if (!resolver_data_status)
+            return resolver_data_status;
+        auto resolver_func_status = wrap_setopt(raw,
+                                                CURLOPT_RESOLVER_START_FUNCTION,
+                                                &resolver_start_callback_helper);
+        if (!resolver_func_status)
+            return resolver_func_status;
+        extra_state.trace_sink = std::move(t);
+        start_trace();
+        return {};
+    }
+
+
+    void
+    easy::unset_tracer()
+        noexcept
+    {
+        if (!extra_state.trace_sink)
+            return;
+        extra_state.trace_sink = {};
+        extra_state.trace_transfer = 0;
+        wrap_unsetopt(raw, CURLOPT_RESOLVER_START_DATA);
+        wrap_unsetopt(raw, CURLOPT_RESOLVER_START_FUNCTION);
+        if (!extra_state.debug_func) {
+            curl_easy_setopt(raw, CURLOPT_VERBOSE, 0L);
+            wrap_unsetopt(raw, CURLOPT_DEBUGDATA);
+            wrap_unsetopt(raw, CURLOPT_DEBUGFUNCTION);
+        }
+    }
+
+
     void
     easy::set_default_protocol(const std::string& protocol)
     {
@@ -1194,13 +1478,17 @@ namespace curl {
             return {};
         }
 
-        auto data_status = wrap_setopt(raw, CURLOPT_FNMATCH_DATA, raw);
+        auto shared_func = share_function(std::move(fnmatch_func));
+        if (!shared_func)
+            return std::unexpected{error{CURLE_OUT_OF_MEMORY}};
+
+        auto data_status = wrap_setopt(raw, CURLOPT_FNMATCH_DATA, this);
         if (!data_status)
             return data_status;
         auto func_status = wrap_setopt(raw, CURLOPT_FNMATCH_FUNCTION, &fnmatch_callback_helper);
         if (!func_status)
             return func_status;
-        extra_state.fnmatch_func = std::move(fnmatch_func);
+        extra_state.fnmatch_func = std::move(shared_func);
         return {};
     }
 
@@ -1306,13 +1594,18 @@ namespace curl {
             return {};
         }
 
-        auto data_status = wrap_setopt(raw, CURLOPT_HEADERDATA, raw);
+        auto shared_func = share_function(std::move(header_func));
+        if (!shared_func)
+            return std::unexpected{error{CURLE_OUT_OF_MEMORY}};
+
+        auto data_status = wrap_setopt(raw, CURLOPT_HEADERDATA, this);
         if (!data_status)
             return data_status;
         auto func_status = wrap_setopt(raw, CURLOPT_HEADERFUNCTION, &header_callback_helper);
         if (!func_status)
             return func_status;
-        extra_state.header_func = std::move(header_func);
+        extra_state.header_func = std::move(shared_func);
+        extra_state.header_bound_statically = false;
         return {};
     }
 
@@ -1322,6 +1615,13 @@ namespace curl {
         noexcept
     {
         extra_state.header_func = {};
+        extra_state.header_bound_statically = false;
+        // The memory body still needs to watch the headers.
+        if (extra_state.memory_body.enabled) {
+            curl_easy_setopt(raw, CURLOPT_HEADERDATA, this);
+            curl_easy_setopt(raw, CURLOPT_HEADERFUNCTION, &header_callback_helper);
+            return;
+        }
         wrap_unsetopt(raw, CURLOPT_HEADERDATA);
         wrap_unsetopt(raw, CURLOPT_HEADERFUNCTION);
     }
@@ -1384,12 +1684,98 @@ namespace curl {
         noexcept
     {
         auto result = wrap_setopt(raw, CURLOPT_HTTPHEADER, headers.data());
-        if (result)
+        if (result) {
             extra_state.http_headers_list = std::move(headers);
+            extra_state.shared_http_headers.reset();
+        }
+        return result;
+    }
+
+
+    void
+    easy::set_http_headers(std::shared_ptr<const slist> headers)
+    {
+        return value_or_throw(try_set_http_headers(std::move(headers)));
+    }
+
+
+    std::expected<void, error>
+    easy::try_set_http_headers(std::shared_ptr<const slist> headers)
+        noexcept
+    {
+        if (!headers) {
+            unset_http_headers();
+            return {};
+        }
+        const curl_slist* list = headers->data();
+        return try_set_shared_http_headers({std::move(headers), list});
+    }
+
+
+    void
+    easy::set_http_headers(arena_slist headers)
+    {
+        return value_or_throw(try_set_http_headers(std::move(headers)));
+    }
+
+
+    std::expected<void, error>
+    easy::try_set_http_headers(arena_slist headers)
+        noexcept
+    {
+        auto owner = share_list(std::move(headers));
+        if (!owner)
+            return std::unexpected{error{CURLE_OUT_OF_MEMORY}};
+        return try_set_http_headers(std::shared_ptr<const arena_slist>{std::move(owner)});
+    }
+
+
+    void
+    easy::set_http_headers(std::shared_ptr<const arena_slist> headers)
+    {
+        return value_or_throw(try_set_http_headers(std::move(headers)));
+    }
+
+
+    std::expected<void, error>
+    easy::try_set_http_headers(std::shared_ptr<const arena_slist> headers)
+        noexcept
+    {
+        if (!headers) {
+            unset_http_headers();
+            return {};
+        }
+        const curl_slist* list = headers->data();
+        return try_set_shared_http_headers({std::move(headers), list});
+    }
+
+
+    std::expected<void, error>
+    easy::try_set_shared_http_headers(std::shared_ptr<const curl_slist> headers)
+        noexcept
+    {
+        // Note: libcurl doesn't modify the list.
+        auto result = wrap_setopt(raw,
+                                  CURLOPT_HTTPHEADER,
+                                  const_cast<curl_slist*>(headers.get()));
+        if (result) {
+            extra_state.shared_http_headers = std::move(headers);
+            extra_state.http_headers_list.destroy();
+        }
         return result;
     }
 
 
+    void
+    easy::unset_http_headers()
+        noexcept
+    {
+        wrap_unsetopt(raw, CURLOPT_HTTPHEADER);
+        extra_state.http_headers_list.destroy();
+        extra_state.shared_http_headers.reset();
+    }
+
+
     void
     easy::append_http_header(const std::string& header)
     {
@@ -1401,6 +1787,25 @@ namespace curl {
     easy::try_append_http_header(const std::string& header)
         noexcept
     {
+        if (extra_state.shared_http_headers) {
+            // Copy on write. The shared list is only released after libcurl points to the
+            // copy, so a failure leaves the handle as it was.
+            slist copy;
+            for (auto node = extra_state.shared_http_headers.get(); node; node = node->next) {
+                auto status = copy.try_append(node->data);
+                if (!status)
+                    return status;
+            }
+            auto status = copy.try_append(header);
+            if (!status)
+                return status;
+            status = wrap_setopt(raw, CURLOPT_HTTPHEADER, copy.data());
+            if (!status)
+                return status;
+            extra_state.http_headers_list = std::move(copy);
+            extra_state.shared_http_headers.reset();
+            return {};
+        }
         auto result = extra_state.http_headers_list.try_append(header);
         if (!result)
             return result;
@@ -1778,13 +2183,17 @@ namespace curl {
             return {};
         }
 
-        auto data_status = wrap_setopt(raw, CURLOPT_OPENSOCKETDATA, raw);
+        auto shared_func = share_function(std::move(opensocket_func));
+        if (!shared_func)
+            return std::unexpected{error{CURLE_OUT_OF_MEMORY}};
+
+        auto data_status = wrap_setopt(raw, CURLOPT_OPENSOCKETDATA, this);
         if (!data_status)
             return data_status;
         auto func_status = wrap_setopt(raw, CURLOPT_OPENSOCKETFUNCTION, &opensocket_callback_helper);
         if (!func_status)
             return func_status;
-        extra_state.opensocket_func = std::move(opensocket_func);
+        extra_state.opensocket_func = std::move(shared_func);
         return {};
     }
 
@@ -1942,7 +2351,11 @@ namespace curl {
             return {};
         }
 
-        auto data_res = wrap_setopt(raw, CURLOPT_READDATA, raw);
+        auto shared_func = share_function(std::move(read_func));
+        if (!shared_func)
+            return std::unexpected{error{CURLE_OUT_OF_MEMORY}};
+
+        auto data_res = wrap_setopt(raw, CURLOPT_READDATA, this);
         if (!data_res)
             return data_res;
 
@@ -1950,7 +2363,8 @@ namespace curl {
         if (!func_res)
             return func_res;
 
-        extra_state.read_func = std::move(read_func);
+        extra_state.read_func = std::move(shared_func);
+        extra_state.read_bound_statically = false;
         return {};
     }
 
@@ -1960,7 +2374,9 @@ namespace curl {
         noexcept
     {
         extra_state.read_func = {};
-        wrap_unsetopt(raw, CURLOPT_READDATA);
+        extra_state.read_bound_statically = false;
+        // The default read function reads from the FILE* in CURLOPT_READDATA.
+        curl_easy_setopt(raw, CURLOPT_READDATA, stdin);
         wrap_unsetopt(raw, CURLOPT_READFUNCTION);
     }
 
@@ -2003,6 +2419,72 @@ namespace curl {
     }
 
 
+    void
+    easy::set_seek_function(seek_function_t seek_func)
+    {
+        return value_or_throw(try_set_seek_function(std::move(seek_func)));
+    }
+
+
+    std::expected<void, error>
+    easy::try_set_seek_function(seek_function_t seek_func)
+        noexcept
+    {
+        if (!seek_func) {
+            unset_seek_function();
+            return {};
+        }
+
+        auto shared_func = share_function(std::move(seek_func));
+        if (!shared_func)
+            return std::unexpected{error{CURLE_OUT_OF_MEMORY}};
+
+        auto data_status = wrap_setopt(raw, CURLOPT_SEEKDATA, this);
+        if (!data_status)
+            return data_status;
+        auto func_status = wrap_setopt(raw, CURLOPT_SEEKFUNCTION, &seek_callback_helper);
+        if (!func_status)
+            return func_status;
+        extra_state.seek_func = std::move(shared_func);
+        extra_state.seek_bound_statically = false;
+        return {};
+    }
+
+
+    void
+    easy::unset_seek_function()
+        noexcept
+    {
+        extra_state.seek_func = {};
+        extra_state.seek_bound_statically = false;
+        wrap_unsetopt(raw, CURLOPT_SEEKDATA);
+        wrap_unsetopt(raw, CURLOPT_SEEKFUNCTION);
+    }
+
+
+    void
+    easy::set_share(share& sh)
+    {
+        return value_or_throw(try_set_share(sh));
+    }
+
+
+    std::expected<void, error>
+    easy::try_set_share(share& sh)
+        noexcept
+    {
+        return wrap_setopt(raw, CURLOPT_SHARE, sh.data());
+    }
+
+
+    void
+    easy::unset_share()
+        noexcept
+    {
+        return wrap_unsetopt(raw, CURLOPT_SHARE);
+    }
+
+
     void
     easy::set_ssl_verify_host(bool enable)
     {
@@ -2351,7 +2833,13 @@ namespace curl {
             return {};
         }
 
-        auto data_res = wrap_setopt(raw, CURLOPT_WRITEDATA, raw);
+        auto shared_func = share_function(std::move(write_func));
+        if (!shared_func)
+            return std::unexpected{error{CURLE_OUT_OF_MEMORY}};
+
+        stop_memory_body();
+
+        auto data_res = wrap_setopt(raw, CURLOPT_WRITEDATA, this);
         if (!data_res)
             return data_res;
 
@@ -2359,7 +2847,9 @@ namespace curl {
         if (!func_res)
             return func_res;
 
-        extra_state.write_func = std::move(write_func);
+        extra_state.write_func = std::move(shared_func);
+        extra_state.write_sink = nullptr;
+        extra_state.write_bound_statically = false;
         return {};
     }
 
@@ -2368,12 +2858,78 @@ namespace curl {
     easy::unset_write_function()
         noexcept
     {
+        stop_memory_body();
         extra_state.write_func = {};
-        wrap_unsetopt(raw, CURLOPT_WRITEDATA);
+        extra_state.write_sink = nullptr;
+        extra_state.write_bound_statically = false;
+        // The default write function writes to the FILE* in CURLOPT_WRITEDATA.
+        curl_easy_setopt(raw, CURLOPT_WRITEDATA, stdout);
         wrap_unsetopt(raw, CURLOPT_WRITEFUNCTION);
     }
 
 
+    void
+    easy::set_write_to_memory(std::size_t max_reserve)
+    {
+        return value_or_throw(try_set_write_to_memory(max_reserve));
+    }
+
+
+    std::expected<void, error>
+    easy::try_set_write_to_memory(std::size_t max_reserve)
+        noexcept
+    {
+        unset_write_function();
+
+        auto data_res = wrap_setopt(raw, CURLOPT_WRITEDATA, this);
+        if (!data_res)
+            return data_res;
+        auto func_res = wrap_setopt(raw, CURLOPT_WRITEFUNCTION, &memory_write_callback_helper);
+        if (!func_res)
+            return func_res;
+
+        if (!extra_state.header_func && !extra_state.header_bound_statically) {
+            auto hdata_res = wrap_setopt(raw, CURLOPT_HEADERDATA, this);
+            if (!hdata_res)
+                return hdata_res;
+            auto hfunc_res = wrap_setopt(raw, CURLOPT_HEADERFUNCTION, &header_callback_helper);
+            if (!hfunc_res)
+                return hfunc_res;
+        }
+
+        extra_state.memory_body.enabled = true;
+        extra_state.memory_body.max_reserve = max_reserve;
+        return {};
+    }
+
+
+    void
+    easy::unset_write_to_memory()
+        noexcept
+    {
+        if (extra_state.memory_body.enabled)
+            unset_write_function();
+    }
+
+
+    std::string_view
+    easy::get_memory_body()
+        const noexcept
+    {
+        return extra_state.memory_body.data;
+    }
+
+
+    std::string
+    easy::take_memory_body()
+        noexcept
+    {
+        std::string result = std::move(extra_state.memory_body.data);
+        extra_state.memory_body.data.clear();
+        return result;
+    }
+
+
     void
     easy::set_ws_options(long mask)
     {
@@ -2405,13 +2961,18 @@ namespace curl {
             return {};
         }
 
-        auto data_status = wrap_setopt(raw, CURLOPT_XFERINFODATA, raw);
+        auto shared_func = share_function(std::move(progress_func));
+        if (!shared_func)
+            return std::unexpected{error{CURLE_OUT_OF_MEMORY}};
+
+        auto data_status = wrap_setopt(raw, CURLOPT_XFERINFODATA, this);
         if (!data_status)
             return data_status;
         auto func_status = wrap_setopt(raw, CURLOPT_XFERINFOFUNCTION, &progress_callback_helper);
         if (!func_status)
             return func_status;
-        extra_state.progress_func = std::move(progress_func);
+        extra_state.progress_func = std::move(shared_func);
+        extra_state.progress_bound_statically = false;
         return {};
     }
 
@@ -2421,6 +2982,7 @@ namespace curl {
         noexcept
     {
         extra_state.progress_func = {};
+        extra_state.progress_bound_statically = false;
         wrap_unsetopt(raw, CURLOPT_XFERINFODATA);
         wrap_unsetopt(raw, CURLOPT_XFERINFOFUNCTION);
     }
@@ -2663,21 +3225,161 @@ namespace curl {
     }
 
 
-    const std::any&
-    easy::get_private()
+    std::chrono::microseconds
+    easy::get_name_lookup_time()
         const
     {
-        return extra_state.private_data;
+        return value_or_throw(try_get_name_lookup_time());
     }
 
 
-    std::any&
+    std::expected<std::chrono::microseconds, error>
+    easy::try_get_name_lookup_time()
+        const noexcept
+    {
+        return wrap_getinfo<curl_off_t, std::chrono::microseconds>(raw,
+                                                                   CURLINFO_NAMELOOKUP_TIME_T);
+    }
+
+
+    long
+    easy::get_num_connects()
+        const
+    {
+        return value_or_throw(try_get_num_connects());
+    }
+
+
+    std::expected<long, error>
+    easy::try_get_num_connects()
+        const noexcept
+    {
+        return wrap_getinfo<long>(raw, CURLINFO_NUM_CONNECTS);
+    }
+
+
+    long
+    easy::get_os_errno()
+        const
+    {
+        return value_or_throw(try_get_os_errno());
+    }
+
+
+    std::expected<long, error>
+    easy::try_get_os_errno()
+        const noexcept
+    {
+        return wrap_getinfo<long>(raw, CURLINFO_OS_ERRNO);
+    }
+
+
+#if CURL_AT_LEAST_VERSION(8, 10, 0)
+
+    std::chrono::microseconds
+    easy::get_post_transfer_time()
+        const
+    {
+        return value_or_throw(try_get_post_transfer_time());
+    }
+
+
+    std::expected<std::chrono::microseconds, error>
+    easy::try_get_post_transfer_time()
+        const noexcept
+    {
+        return wrap_getinfo<curl_off_t, std::chrono::microseconds>(raw,
+                                                                   CURLINFO_POSTTRANSFER_TIME_T);
+    }
+
+#endif // CURL_AT_LEAST_VERSION(8, 10, 0)
+
+
+    std::chrono::microseconds
+    easy::get_pre_transfer_time()
+        const
+    {
+        return value_or_throw(try_get_pre_transfer_time());
+    }
+
+
+    std::expected<std::chrono::microseconds, error>
+    easy::try_get_pre_transfer_time()
+        const noexcept
+    {
+        return wrap_getinfo<curl_off_t, std::chrono::microseconds>(raw,
+                                                                   CURLINFO_PRETRANSFER_TIME_T);
+    }
+
+
+    const std::any&
+    easy::get_private()
+        const
+    {
+        return extra_state.private_data;
+    }
+
+
+    std::any&
     easy::get_private()
     {
         return extra_state.private_data;
     }
 
 
+#if CURL_AT_LEAST_VERSION(8, 6, 0)
+
+    std::chrono::microseconds
+    easy::get_queue_time()
+        const
+    {
+        return value_or_throw(try_get_queue_time());
+    }
+
+
+    std::expected<std::chrono::microseconds, error>
+    easy::try_get_queue_time()
+        const noexcept
+    {
+        return wrap_getinfo<curl_off_t, std::chrono::microseconds>(raw, CURLINFO_QUEUE_TIME_T);
+    }
+
+#endif // CURL_AT_LEAST_VERSION(8, 6, 0)
+
+
+    long
+    easy::get_redirect_count()
+        const
+    {
+        return value_or_throw(try_get_redirect_count());
+    }
+
+
+    std::expected<long, error>
+    easy::try_get_redirect_count()
+        const noexcept
+    {
+        return wrap_getinfo<long>(raw, CURLINFO_REDIRECT_COUNT);
+    }
+
+
+    std::chrono::microseconds
+    easy::get_redirect_time()
+        const
+    {
+        return value_or_throw(try_get_redirect_time());
+    }
+
+
+    std::expected<std::chrono::microseconds, error>
+    easy::try_get_redirect_time()
+        const noexcept
+    {
+        return wrap_getinfo<curl_off_t, std::chrono::microseconds>(raw,
+                                                                   CURLINFO_REDIRECT_TIME_T);
+    }
+
+
     long
     easy::get_response_code()
         const
@@ -2809,6 +3511,56 @@ namespace curl {
     }
 
 
+    easy::transfer_stats
+    easy::get_transfer_stats()
+        const
+    {
+        return value_or_throw(try_get_transfer_stats());
+    }
+
+
+    std::expected<easy::transfer_stats, error>
+    easy::try_get_transfer_stats()
+        const noexcept
+    {
+        transfer_stats stats;
+        CURLcode status = CURLE_OK;
+
+#if CURL_AT_LEAST_VERSION(8, 6, 0)
+        getinfo_into<curl_off_t>(raw, CURLINFO_QUEUE_TIME_T, stats.queue, status);
+#endif
+        getinfo_into<curl_off_t>(raw, CURLINFO_NAMELOOKUP_TIME_T, stats.name_lookup, status);
+        getinfo_into<curl_off_t>(raw, CURLINFO_CONNECT_TIME_T, stats.connect, status);
+        getinfo_into<curl_off_t>(raw, CURLINFO_APPCONNECT_TIME_T, stats.app_connect, status);
+        getinfo_into<curl_off_t>(raw, CURLINFO_PRETRANSFER_TIME_T, stats.pre_transfer, status);
+#if CURL_AT_LEAST_VERSION(8, 10, 0)
+        getinfo_into<curl_off_t>(raw, CURLINFO_POSTTRANSFER_TIME_T, stats.post_transfer, status);
+#endif
+        getinfo_into<curl_off_t>(raw, CURLINFO_STARTTRANSFER_TIME_T, stats.start_transfer, status);
+        getinfo_into<curl_off_t>(raw, CURLINFO_TOTAL_TIME_T, stats.total, status);
+        getinfo_into<curl_off_t>(raw, CURLINFO_REDIRECT_TIME_T, stats.redirect, status);
+
+        getinfo_into<curl_off_t>(raw, CURLINFO_SIZE_DOWNLOAD_T, stats.size_download, status);
+        getinfo_into<curl_off_t>(raw, CURLINFO_SIZE_UPLOAD_T, stats.size_upload, status);
+        getinfo_into<long>(raw, CURLINFO_HEADER_SIZE, stats.header_size, status);
+        getinfo_into<long>(raw, CURLINFO_REQUEST_SIZE, stats.request_size, status);
+
+#if CURL_AT_LEAST_VERSION(8, 2, 0)
+        getinfo_into<curl_off_t>(raw, CURLINFO_CONN_ID, stats.conn_id, status);
+#endif
+        getinfo_into<long>(raw, CURLINFO_NUM_CONNECTS, stats.num_connects, status);
+        getinfo_into<long>(raw, CURLINFO_REDIRECT_COUNT, stats.redirect_count, status);
+        getinfo_into<long>(raw, CURLINFO_RESPONSE_CODE, stats.response_code, status);
+
+        if (status)
+            return std::unexpected{error{status}};
+
+        // The transfer got to use a connection, without creating a new one.
+        stats.reused_connection = stats.num_connects == 0 && stats.pre_transfer.count() > 0;
+        return stats;
+    }
+
+
     header
     easy::get_header(const std::string& name,
                      std::size_t index,
@@ -2842,6 +3594,90 @@ namespace curl {
     }
 
 
+    header_view
+    easy::get_header_view(const char* name,
+                          std::size_t index,
+                          unsigned origin,
+                          int request)
+        const
+    {
+        return value_or_throw(try_get_header_view(name, index, origin, request));
+    }
+
+
+    header_view
+    easy::get_header_view(const std::string& name,
+                          std::size_t index,
+                          unsigned origin,
+                          int request)
+        const
+    {
+        return get_header_view(name.data(), index, origin, request);
+    }
+
+
+    std::expected<header_view, error>
+    easy::try_get_header_view(const char* name,
+                              std::size_t index,
+                              unsigned origin,
+                              int request)
+        const noexcept
+    {
+        curl_header* h = nullptr;
+        auto e = curl_easy_header(raw,
+                                  name,
+                                  index,
+                                  origin,
+                                  request,
+                                  &h);
+        if (e != CURLHE_OK)
+            return std::unexpected{error{e}};
+        if (!h)
+            return std::unexpected{error{"no header found!"}};
+        return header_view{h};
+    }
+
+
+    std::expected<header_view, error>
+    easy::try_get_header_view(const std::string& name,
+                              std::size_t index,
+                              unsigned origin,
+                              int request)
+        const noexcept
+    {
+        return try_get_header_view(name.data(), index, origin, request);
+    }
+
+
+    std::optional<header_view>
+    easy::find_header_view(const char* name,
+                           std::size_t index,
+                           unsigned origin,
+                           int request)
+        const noexcept
+    {
+        curl_header* h = nullptr;
+        auto e = curl_easy_header(raw,
+                                  name,
+                                  index,
+                                  origin,
+                                  request,
+                                  &h);
+        if (e != CURLHE_OK || !h)
+            return {};
+        return header_view{h};
+    }
+
+
+    header_range
+    easy::get_headers(unsigned origin,
+                      int request)
+        const noexcept
+    {
+        return header_range{raw, origin, request};
+    }
+
+
     easy*
     easy::get_wrapper(CURL* handle)
         noexcept
@@ -2872,22 +3708,221 @@ namespace curl {
                              CURLOPT_ERRORBUFFER,
                              extra_state.error_buffer.data());
 
-            curl_easy_setopt(raw, CURLOPT_STDERR, stdout); // TODO: remove this
+            // The callback helpers get this object through the *DATA options, so they
+            // must follow the object when it's moved.
+            if (extra_state.closesocket_func)
+                curl_easy_setopt(raw, CURLOPT_CLOSESOCKETDATA, this);
+            if (extra_state.debug_func || extra_state.trace_sink)
+                curl_easy_setopt(raw, CURLOPT_DEBUGDATA, this);
+            if (extra_state.fnmatch_func)
+                curl_easy_setopt(raw, CURLOPT_FNMATCH_DATA, this);
+            if (extra_state.header_func
+                || (extra_state.memory_body.enabled && !extra_state.header_bound_statically))
+                curl_easy_setopt(raw, CURLOPT_HEADERDATA, this);
+            if (extra_state.opensocket_func)
+                curl_easy_setopt(raw, CURLOPT_OPENSOCKETDATA, this);
+            if (extra_state.progress_func)
+                curl_easy_setopt(raw, CURLOPT_XFERINFODATA, this);
+            if (extra_state.read_func)
+                curl_easy_setopt(raw, CURLOPT_READDATA, this);
+            if (extra_state.trace_sink)
+                curl_easy_setopt(raw, CURLOPT_RESOLVER_START_DATA, this);
+            if (extra_state.seek_func)
+                curl_easy_setopt(raw, CURLOPT_SEEKDATA, this);
+            if (extra_state.write_func
+                || extra_state.write_sink
+                || extra_state.memory_body.enabled)
+                curl_easy_setopt(raw, CURLOPT_WRITEDATA, this);
+
+            // After a copy, the handle still points to the original's lists and URL.
+            if (extra_state.http_headers_list)
+                curl_easy_setopt(raw, CURLOPT_HTTPHEADER, extra_state.http_headers_list.data());
+            else if (extra_state.shared_http_headers)
+                curl_easy_setopt(raw,
+                                 CURLOPT_HTTPHEADER,
+                                 extra_state.shared_http_headers.get());
+            if (extra_state.connect_to_list)
+                curl_easy_setopt(raw, CURLOPT_CONNECT_TO, extra_state.connect_to_list.data());
+            else if (extra_state.shared_connect_to)
+                curl_easy_setopt(raw,
+                                 CURLOPT_CONNECT_TO,
+                                 extra_state.shared_connect_to.get());
+            if (extra_state.url_obj)
+                curl_easy_setopt(raw, CURLOPT_CURLU, extra_state.url_obj.data());
         } else {
             extra_state = {};
         }
     }
 
 
+    void
+    easy::adopt_duplicate(CURL* new_raw,
+                          const easy* original)
+    {
+        auto new_state = original ? clone_extra_state(original->extra_state)
+                                  : extra_state_type{};
+        destroy();
+        acquire(state_type{new_raw, std::move(new_state)});
+        unset_duplicated_callbacks(original ? &original->extra_state : nullptr);
+        if (extra_state.trace_sink)
+            start_trace();
+    }
+
+
+    void
+    easy::unset_duplicated_callbacks(const extra_state_type* original)
+        noexcept
+    {
+        if (!original || original->closesocket_func)
+            unset_closesocket_function();
+        if (!original || original->debug_func)
+            unset_debug_function();
+        if (!original || original->fnmatch_func)
+            unset_fnmatch_function();
+        if (!original || original->header_func || original->header_bound_statically)
+            unset_header_function();
+        if (!original || original->opensocket_func)
+            unset_opensocket_function();
+        if (!original || original->progress_func || original->progress_bound_statically)
+            unset_xfer_info_function();
+        if (!original || original->read_func || original->read_bound_statically)
+            unset_read_function();
+        if (!original || original->seek_func || original->seek_bound_statically)
+            unset_seek_function();
+        if (!original
+            || original->write_func
+            || original->write_sink
+            || original->write_bound_statically)
+            unset_write_function();
+    }
+
+
+    void
+    easy::start_trace()
+        noexcept
+    {
+        extra_state.trace_transfer = extra_state.trace_sink->start_transfer();
+        extra_state.trace_first_byte = false;
+        bool verbose = extra_state.trace_transfer || extra_state.debug_func;
+        curl_easy_setopt(raw, CURLOPT_VERBOSE, long{verbose});
+    }
+
+
+    void
+    easy::finish_trace(CURLcode result)
+        noexcept
+    {
+        if (!extra_state.trace_sink)
+            return;
+        auto& sink = *extra_state.trace_sink;
+        auto transfer = extra_state.trace_transfer;
+        if (transfer) {
+            auto now = std::chrono::steady_clock::now();
+            // The connection steps are taken from libcurl's timing info, measured from
+            // the start of the transfer.
+            if (auto stats = try_get_transfer_stats()) {
+                auto start = now - stats->total;
+                if (stats->reused_connection)
+                    sink.record(start + stats->pre_transfer,
+                                transfer,
+                                trace_event::connection_reused);
+                else if (stats->num_connects > 0) {
+                    sink.record(start + stats->name_lookup,
+                                transfer,
+                                trace_event::connect_start);
+                    if (stats->connect.count() > 0)
+                        sink.record(start + stats->connect,
+                                    transfer,
+                                    trace_event::connected);
+                    if (stats->app_connect.count() > 0)
+                        sink.record(start + stats->app_connect,
+                                    transfer,
+                                    trace_event::tls_done);
+                }
+            }
+            sink.record(now, transfer, trace_event::done, result);
+        }
+        start_trace();
+    }
+
+
+    void
+    easy::start_transfer()
+        noexcept
+    {
+        // The previous transfer might not have finished: it could have been removed from a
+        // multi handle before completing.
+        extra_state.write_sink_started = false;
+        // Not every protocol has a status line to reset these, see watch_content_length().
+        extra_state.memory_body.expected = -1;
+        extra_state.memory_body.reserved = false;
+    }
+
+
+    void
+    easy::finish_transfer(CURLcode result)
+        noexcept
+    {
+        extra_state.write_sink_started = false;
+        if (extra_state.trace_sink)
+            finish_trace(result);
+    }
+
+
+    void
+    easy::trace_debug(curl_infotype type,
+                      std::span<const char> data)
+        noexcept
+    {
+        auto& sink = *extra_state.trace_sink;
+        auto transfer = extra_state.trace_transfer;
+        auto size = static_cast<std::uint32_t>(data.size());
+
+        // Only the kind of data is looked at, never libcurl's text messages, which change
+        // between versions and TLS backends.
+        switch (type) {
+            case CURLINFO_HEADER_OUT:
+                sink.record(transfer, trace_event::header_out, size);
+                break;
+
+            case CURLINFO_HEADER_IN:
+            case CURLINFO_DATA_IN:
+                if (!extra_state.trace_first_byte) {
+                    extra_state.trace_first_byte = true;
+                    sink.record(transfer, trace_event::first_byte);
+                }
+                if (type == CURLINFO_HEADER_IN)
+                    sink.record(transfer, trace_event::header_in, size);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+
+    void
+    easy::stop_memory_body()
+        noexcept
+    {
+        if (!extra_state.memory_body.enabled)
+            return;
+        extra_state.memory_body = {};
+        if (!extra_state.header_func && !extra_state.header_bound_statically) {
+            wrap_unsetopt(raw, CURLOPT_HEADERDATA);
+            wrap_unsetopt(raw, CURLOPT_HEADERFUNCTION);
+        }
+    }
+
+
     int
-    easy::closesocket_callback_helper(CURL* handle,
+    easy::closesocket_callback_helper(easy* ez,
                                       curl_socket_t fd)
         noexcept
     {
-        easy* ez = get_wrapper(handle);
         try {
             if (ez && ez->extra_state.closesocket_func)
-                return ez->extra_state.closesocket_func(fd);
+                return (*ez->extra_state.closesocket_func)(fd);
             else
                 return 1;
         }
@@ -2902,13 +3937,14 @@ namespace curl {
                                 curl_infotype type,
                                 char *data,
                                 std::size_t size,
-                                CURL* handle)
+                                easy* ez)
         noexcept
     {
-        easy* ez = get_wrapper(handle);
         try {
+            if (ez && ez->extra_state.trace_transfer)
+                ez->trace_debug(type, {data, size});
             if (ez && ez->extra_state.debug_func)
-                ez->extra_state.debug_func(target, type, {data, size});
+                (*ez->extra_state.debug_func)(target, type, {data, size});
         }
         catch (...) {
         }
@@ -2917,17 +3953,16 @@ namespace curl {
 
 
     int
-    easy::fnmatch_callback_helper(CURL* handle,
+    easy::fnmatch_callback_helper(easy* ez,
                                   const char* pattern,
                                   const char* text)
         noexcept
     {
-        easy* ez = get_wrapper(handle);
         if (!ez || !ez->extra_state.fnmatch_func)
             return CURL_FNMATCHFUNC_FAIL;
 
         try {
-            if (ez->extra_state.fnmatch_func(pattern, text))
+            if ((*ez->extra_state.fnmatch_func)(pattern, text))
                 return CURL_FNMATCHFUNC_MATCH;
             else
                 return CURL_FNMATCHFUNC_NOMATCH;
@@ -2942,13 +3977,19 @@ namespace curl {
     easy::header_callback_helper(char* buffer,
                                  std::size_t size,
                                  std::size_t nitems,
-                                 CURL* handle)
+                                 easy* ez)
         noexcept
     {
-        easy* ez = get_wrapper(handle);
+        if (!ez)
+            return CURL_WRITEFUNC_ERROR;
+        auto& body = ez->extra_state.memory_body;
+        if (body.enabled)
+            watch_content_length(body, {buffer, size * nitems});
         try {
-            if (ez && ez->extra_state.header_func)
-                return ez->extra_state.header_func({buffer, size * nitems});
+            if (ez->extra_state.header_func)
+                return (*ez->extra_state.header_func)({buffer, size * nitems});
+            else if (body.enabled)
+                return size * nitems;
             else
                 return CURL_WRITEFUNC_ERROR;
         }
@@ -2958,16 +3999,46 @@ namespace curl {
     }
 
 
+    std::size_t
+    easy::memory_write_callback_helper(const char* buffer,
+                                       std::size_t,
+                                       std::size_t size,
+                                       easy* ez)
+        noexcept
+    {
+        if (!ez)
+            return CURL_WRITEFUNC_ERROR;
+        auto& body = ez->extra_state.memory_body;
+        try {
+            if (!body.reserved) {
+                body.reserved = true;
+                curl_off_t length = body.expected;
+                // The header function might have been replaced, ask libcurl instead.
+                if (length < 0)
+                    curl_easy_getinfo(ez->raw, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+                if (length > 0) {
+                    auto amount = std::min<std::uint64_t>(length, body.max_reserve);
+                    body.data.reserve(body.data.size() + amount);
+                }
+            }
+            body.data.append(buffer, size);
+            return size;
+        }
+        catch (...) {
+            return CURL_WRITEFUNC_ERROR;
+        }
+    }
+
+
     curl_socket_t
-    easy::opensocket_callback_helper(CURL* handle,
+    easy::opensocket_callback_helper(easy* ez,
                                      curlsocktype purpose,
                                      curl_sockaddr* address)
         noexcept
     {
-        easy* ez = get_wrapper(handle);
         try {
             if (ez && ez->extra_state.opensocket_func)
-                return ez->extra_state.opensocket_func(purpose, address);
+                return (*ez->extra_state.opensocket_func)(purpose, address);
             else
                 return CURL_SOCKET_BAD;
         }
@@ -2978,14 +4049,13 @@ namespace curl {
 
 
     int
-    easy::progress_callback_helper(CURL* handle,
+    easy::progress_callback_helper(easy* ez,
                                    curl_off_t dltotal,
                                    curl_off_t dlnow,
                                    curl_off_t ultotal,
                                    curl_off_t ulnow)
         noexcept
     {
-        easy* ez = get_wrapper(handle);
         if (!ez)
             return 1; // cause CURLE_ABORTED_BY_CALLBACK error
 
@@ -2993,7 +4063,7 @@ namespace curl {
             return CURL_PROGRESSFUNC_CONTINUE; // fall back to built-in progress callback
 
         try {
-            return ez->extra_state.progress_func(dltotal, dlnow, ultotal, ulnow);
+            return (*ez->extra_state.progress_func)(dltotal, dlnow, ultotal, ulnow);
         }
         catch (...) {
             return 1; // cause CURLE_ABORTED_BY_CALLBACK error
@@ -3005,13 +4075,12 @@ namespace curl {
     easy::read_callback_helper(char* buf,
                                std::size_t,
                                std::size_t size,
-                               CURL* handle)
+                               easy* ez)
         noexcept
     {
-        easy* ez = get_wrapper(handle);
         try {
             if (ez && ez->extra_state.read_func)
-                return ez->extra_state.read_func({buf, size});
+                return (*ez->extra_state.read_func)({buf, size});
             else
                 return CURL_READFUNC_ABORT;
         }
@@ -3021,17 +4090,47 @@ namespace curl {
     }
 
 
+    int
+    easy::resolver_start_callback_helper(void*,
+                                         void*,
+                                         easy* ez)
+        noexcept
+    {
+        if (ez && ez->extra_state.trace_transfer)
+            ez->extra_state.trace_sink->record(ez->extra_state.trace_transfer,
+                                               trace_event::resolve_start);
+        return 0;
+    }
+
+
+    int
+    easy::seek_callback_helper(easy* ez,
+                               curl_off_t offset,
+                               int origin)
+        noexcept
+    {
+        try {
+            if (ez && ez->extra_state.seek_func)
+                return (*ez->extra_state.seek_func)(offset, origin);
+            else
+                return CURL_SEEKFUNC_CANTSEEK;
+        }
+        catch (...) {
+            return CURL_SEEKFUNC_FAIL;
+        }
+    }
+
+
     std::size_t
     easy::write_callback_helper(const char* buffer,
                                 std::size_t,
                                 std::size_t size,
-                                CURL* handle)
+                                easy* ez)
         noexcept
     {
-        easy* ez = get_wrapper(handle);
         try {
             if (ez && ez->extra_state.write_func)
-                return ez->extra_state.write_func({buffer, size});
+                return (*ez->extra_state.write_func)({buffer, size});
             else
                 return CURL_WRITEFUNC_ERROR;
         }
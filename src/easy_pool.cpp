@@ -0,0 +1,123 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include <utility>
+#include <vector>
+
+#include "curlxx/easy_pool.hpp"
+
+
+namespace curl {
+
+    easy_pool::easy_pool(std::size_t max_idle,
+                         setup_function_t setup) :
+        max_idle{max_idle},
+        setup{std::move(setup)}
+    {}
+
+
+    void
+    easy_pool::prepare(easy& ez)
+    {
+        if (setup)
+            setup(ez);
+    }
+
+
+    easy
+    easy_pool::acquire()
+    {
+        {
+            std::lock_guard guard{mutex};
+            if (!idle.empty()) {
+                easy result = std::move(idle.back());
+                idle.pop_back();
+                return result;
+            }
+        }
+
+        easy result;
+        prepare(result);
+        return result;
+    }
+
+
+    void
+    easy_pool::release(easy ez)
+    {
+        if (!ez)
+            return;
+
+        {
+            std::lock_guard guard{mutex};
+            if (idle.size() >= max_idle)
+                return;
+        }
+
+        // Reset outside the lock, it's the expensive part.
+        ez.reset();
+        prepare(ez);
+
+        std::lock_guard guard{mutex};
+        if (idle.size() < max_idle)
+            idle.push_back(std::move(ez));
+    }
+
+
+    void
+    easy_pool::reserve(std::size_t n)
+    {
+        if (n > max_idle)
+            n = max_idle;
+
+        std::size_t missing;
+        {
+            std::lock_guard guard{mutex};
+            if (idle.size() >= n)
+                return;
+            missing = n - idle.size();
+        }
+
+        // Create them outside the lock, like release() does: the setup function can be
+        // slow, or use this pool.
+        std::vector<easy> fresh;
+        fresh.reserve(missing);
+        while (fresh.size() < missing) {
+            easy ez;
+            prepare(ez);
+            fresh.push_back(std::move(ez));
+        }
+
+        // Other threads might have filled the pool meanwhile; the extra handles are
+        // destroyed after the lock is released.
+        std::lock_guard guard{mutex};
+        idle.reserve(n);
+        while (idle.size() < n && !fresh.empty()) {
+            idle.push_back(std::move(fresh.back()));
+            fresh.pop_back();
+        }
+    }
+
+
+    void
+    easy_pool::clear()
+        noexcept
+    {
+        std::lock_guard guard{mutex};
+        idle.clear();
+    }
+
+
+    std::size_t
+    easy_pool::get_idle()
+        const
+    {
+        std::lock_guard guard{mutex};
+        return idle.size();
+    }
+
+} // namespace curl
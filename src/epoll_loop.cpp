@@ -0,0 +1,252 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include <array>
+#include <cerrno>
+#include <system_error>
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "curlxx/epoll_loop.hpp"
+
+#include "curlxx/multi.hpp"
+
+
+namespace curl {
+
+    namespace {
+
+        [[noreturn]]
+        void
+        throw_errno(const char* what)
+        {
+            throw std::system_error{errno, std::generic_category(), what};
+        }
+
+
+        std::uint32_t
+        to_epoll_events(int what)
+            noexcept
+        {
+            std::uint32_t result = 0;
+            if (what & CURL_POLL_IN)
+                result |= EPOLLIN;
+            if (what & CURL_POLL_OUT)
+                result |= EPOLLOUT;
+            return result;
+        }
+
+
+        int
+        to_curl_events(std::uint32_t events)
+            noexcept
+        {
+            int result = 0;
+            if (events & EPOLLIN)
+                result |= CURL_CSELECT_IN;
+            if (events & EPOLLOUT)
+                result |= CURL_CSELECT_OUT;
+            if (events & (EPOLLERR | EPOLLHUP))
+                result |= CURL_CSELECT_ERR;
+            return result;
+        }
+
+    } // namespace
+
+
+    epoll_loop::epoll_loop(multi& m) :
+        target{&m}
+    {
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd == -1)
+            throw_errno("epoll_create1()");
+
+        timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (timer_fd == -1) {
+            int saved_errno = errno;
+            close_fds();
+            errno = saved_errno;
+            throw_errno("timerfd_create()");
+        }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = timer_fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev) == -1) {
+            int saved_errno = errno;
+            close_fds();
+            errno = saved_errno;
+            throw_errno("epoll_ctl()");
+        }
+
+        try {
+            target->set_socket_function([this](easy*,
+                                               curl_socket_t s,
+                                               int what,
+                                               void* socket_data)
+                                        {
+                                            return on_socket(s, what, socket_data);
+                                        });
+        }
+        catch (...) {
+            close_fds();
+            throw;
+        }
+
+        try {
+            target->set_timer_function([this](std::chrono::milliseconds timeout)
+                                       {
+                                           return on_timer(timeout);
+                                       });
+        }
+        catch (...) {
+            // The destructor won't run, so don't leave the multi calling back into this.
+            target->unset_socket_function();
+            close_fds();
+            throw;
+        }
+    }
+
+
+    epoll_loop::~epoll_loop()
+        noexcept
+    {
+        if (target) {
+            target->unset_socket_function();
+            target->unset_timer_function();
+        }
+        close_fds();
+    }
+
+
+    void
+    epoll_loop::close_fds()
+        noexcept
+    {
+        if (timer_fd != -1) {
+            ::close(timer_fd);
+            timer_fd = -1;
+        }
+        if (epoll_fd != -1) {
+            ::close(epoll_fd);
+            epoll_fd = -1;
+        }
+    }
+
+
+    int
+    epoll_loop::on_socket(curl_socket_t s,
+                          int what,
+                          void* socket_data)
+    {
+        if (what == CURL_POLL_REMOVE) {
+            // Note: the socket might be already closed, so errors are ignored.
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, s, nullptr);
+            return 0;
+        }
+
+        epoll_event ev{};
+        ev.events = to_epoll_events(what);
+        ev.data.fd = s;
+        // The socket data is only set after the socket was added to this epoll set.
+        // Another value can be left over from an earlier loop on the same multi handle.
+        if (socket_data == this) {
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, s, &ev) == -1)
+                return -1;
+        } else {
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, s, &ev) == -1)
+                return -1;
+            if (!target->try_assign(s, this))
+                return -1;
+        }
+        return 0;
+    }
+
+
+    int
+    epoll_loop::on_timer(std::chrono::milliseconds timeout)
+    {
+        itimerspec spec{};
+        if (timeout.count() > 0) {
+            auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+            auto nsecs = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - secs);
+            spec.it_value.tv_sec = secs.count();
+            spec.it_value.tv_nsec = nsecs.count();
+        } else if (timeout.count() == 0) {
+            // A zero value would disarm the timer, use the smallest delay instead.
+            spec.it_value.tv_nsec = 1;
+        }
+        if (timerfd_settime(timer_fd, 0, &spec, nullptr) == -1)
+            return -1;
+        return 0;
+    }
+
+
+    unsigned
+    epoll_loop::run_once(std::chrono::milliseconds timeout)
+    {
+        std::array<epoll_event, 64> events;
+        int timeout_ms = timeout.count() < 0 ? -1 : static_cast<int>(timeout.count());
+        int n = epoll_wait(epoll_fd, events.data(), events.size(), timeout_ms);
+        if (n == -1) {
+            if (errno == EINTR)
+                return running;
+            throw_errno("epoll_wait()");
+        }
+        ++wakeups;
+
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == timer_fd) {
+                std::uint64_t expirations;
+                while (::read(timer_fd, &expirations, sizeof expirations) > 0)
+                    ;
+                running = target->socket_action(CURL_SOCKET_TIMEOUT, 0);
+            } else
+                running = target->socket_action(fd, to_curl_events(events[i].events));
+        }
+
+        return running;
+    }
+
+
+    void
+    epoll_loop::run()
+    {
+        // Kick off any transfer that was added before the loop started.
+        running = target->socket_action(CURL_SOCKET_TIMEOUT, 0);
+        while (running)
+            run_once();
+    }
+
+
+    unsigned
+    epoll_loop::get_running()
+        const noexcept
+    {
+        return running;
+    }
+
+
+    std::uint64_t
+    epoll_loop::get_wakeups()
+        const noexcept
+    {
+        return wakeups;
+    }
+
+
+    int
+    epoll_loop::get_fd()
+        const noexcept
+    {
+        return epoll_fd;
+    }
+
+} // namespace curl
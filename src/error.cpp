@@ -54,6 +54,13 @@ namespace curl {
     }
 
 
+    string
+    to_string(CURLSHcode code)
+    {
+        return curl_share_strerror(code);
+    }
+
+
     string
     to_string(CURLsslset code)
     {
@@ -104,6 +111,11 @@ namespace curl {
     {}
 
 
+    error::error(CURLSHcode code) :
+        runtime_error{to_string(code)}
+    {}
+
+
     error::error(CURLsslset code) :
         runtime_error{to_string(code)}
     {}
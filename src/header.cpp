@@ -1,6 +1,6 @@
 /*
  * curlxx - A C++ wrapper for libcurl.
- * Copyright 2025  Daniel K. O. (dkosmari)
+ * Copyright 2025-2026  Daniel K. O. (dkosmari)
  *
  * SPDX-License-Identifier: LGPL-3.0-or-later
  */
@@ -9,6 +9,16 @@
 
 namespace curl {
 
+    header_view::header_view(const curl_header* h)
+        noexcept :
+        name{h->name},
+        value{h->value},
+        amount{h->amount},
+        index{h->index},
+        origin{h->origin}
+    {}
+
+
     header::header(const curl_header* h) :
         name{h->name},
         value{h->value},
@@ -17,4 +27,63 @@ namespace curl {
         origin{h->origin}
     {}
 
+
+    header::header(const header_view& hv) :
+        name{hv.name},
+        value{hv.value},
+        amount{hv.amount},
+        index{hv.index},
+        origin{hv.origin}
+    {}
+
+
+    header_range::iterator::iterator(CURL* handle,
+                                     unsigned origin,
+                                     int request)
+        noexcept :
+        handle{handle},
+        origin{origin},
+        request{request}
+    {
+        advance();
+    }
+
+
+    void
+    header_range::iterator::advance()
+        noexcept
+    {
+        current = curl_easy_nextheader(handle, origin, request, current);
+        if (current)
+            view = header_view{current};
+        else
+            view = {};
+    }
+
+
+    header_range::header_range(CURL* handle,
+                               unsigned origin,
+                               int request)
+        noexcept :
+        handle{handle},
+        origin{origin},
+        request{request}
+    {}
+
+
+    header_range::iterator
+    header_range::begin()
+        const noexcept
+    {
+        return iterator{handle, origin, request};
+    }
+
+
+    std::default_sentinel_t
+    header_range::end()
+        const noexcept
+    {
+        return std::default_sentinel;
+    }
+
 } // namespace curl
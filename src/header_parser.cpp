@@ -0,0 +1,190 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include <charconv>
+#include <utility>
+
+#include "curlxx/header_parser.hpp"
+
+
+namespace curl {
+
+    namespace {
+
+        bool
+        is_space(char c)
+            noexcept
+        {
+            return c == ' ' || c == '\t';
+        }
+
+
+        std::string_view
+        trim(std::string_view str)
+            noexcept
+        {
+            while (!str.empty() && is_space(str.front()))
+                str.remove_prefix(1);
+            while (!str.empty() && is_space(str.back()))
+                str.remove_suffix(1);
+            return str;
+        }
+
+
+        bool
+        parse_status(std::string_view line,
+                     header_parser::status_line& status)
+            noexcept
+        {
+            auto sp = line.find(' ');
+            if (sp == std::string_view::npos)
+                return false;
+            status.version = line.substr(0, sp);
+            line = trim(line.substr(sp + 1));
+
+            int code = 0;
+            auto [ptr, ec] = std::from_chars(line.data(), line.data() + line.size(), code);
+            if (ec != std::errc{})
+                return false;
+            status.code = code;
+            line.remove_prefix(ptr - line.data());
+            status.reason = trim(line);
+            return true;
+        }
+
+    } // namespace
+
+
+    header_parser::header_parser(matcher_t matcher)
+        noexcept :
+        matcher{matcher}
+    {}
+
+
+    void
+    header_parser::set_status_function(status_function_t func)
+        noexcept
+    {
+        status_func = std::move(func);
+    }
+
+
+    void
+    header_parser::set_header_function(header_function_t func)
+        noexcept
+    {
+        header_func = std::move(func);
+    }
+
+
+    void
+    header_parser::set_end_function(end_function_t func)
+        noexcept
+    {
+        end_func = std::move(func);
+    }
+
+
+    void
+    header_parser::flush()
+    {
+        if (!has_pending)
+            return;
+        has_pending = false;
+        if (header_func) {
+            std::string_view all = pending;
+            header_func(pending_id,
+                        all.substr(0, pending_name_size),
+                        all.substr(pending_name_size));
+        }
+    }
+
+
+    std::size_t
+    header_parser::write(std::span<const char> data)
+    {
+        std::string_view line{data.data(), data.size()};
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+            line.remove_suffix(1);
+
+        // End of the response block.
+        if (line.empty()) {
+            flush();
+            if (end_func)
+                end_func(status_code);
+            return data.size();
+        }
+
+        // Obsolete line folding: continue the previous header.
+        if (is_space(line.front())) {
+            if (has_pending) {
+                auto extra = trim(line);
+                if (!extra.empty()) {
+                    if (pending.size() > pending_name_size)
+                        pending += ' ';
+                    pending += extra;
+                }
+            }
+            return data.size();
+        }
+
+        flush();
+
+        if (line.starts_with("HTTP/")) {
+            status_line status;
+            if (parse_status(line, status)) {
+                status_code = status.code;
+                if (status_func)
+                    status_func(status);
+            }
+            return data.size();
+        }
+
+        auto colon = line.find(':');
+        if (colon == std::string_view::npos)
+            return data.size(); // not a header field, ignore it
+
+        auto name = trim(line.substr(0, colon));
+        auto value = trim(line.substr(colon + 1));
+
+        std::size_t id = npos;
+        if (matcher) {
+            id = matcher(name);
+            if (id == npos)
+                return data.size();
+        }
+
+        if (!header_func)
+            return data.size();
+
+        pending.assign(name);
+        pending += value;
+        pending_name_size = name.size();
+        pending_id = id;
+        has_pending = true;
+        return data.size();
+    }
+
+
+    void
+    header_parser::reset()
+        noexcept
+    {
+        pending.clear();
+        has_pending = false;
+        status_code = 0;
+    }
+
+
+    int
+    header_parser::get_status_code()
+        const noexcept
+    {
+        return status_code;
+    }
+
+} // namespace curl
@@ -0,0 +1,708 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <mutex>
+
+#include "curlxx/metrics.hpp"
+
+
+using std::chrono::microseconds;
+
+
+namespace curl {
+
+    namespace {
+
+        /*-----------------------*/
+        /* Function declarations */
+        /*-----------------------*/
+
+        std::string_view
+        host_of(std::string_view url)
+            noexcept;
+
+
+        microseconds
+        elapsed(microseconds later,
+                microseconds earlier)
+            noexcept;
+
+
+        template<typename T,
+                 typename U>
+        void
+        getinfo_into(CURL* handle,
+                     CURLINFO info,
+                     U& dest)
+            noexcept;
+
+
+        void
+        append_uint(std::string& out,
+                    std::uint64_t value);
+
+
+        void
+        append_seconds(std::string& out,
+                       microseconds value);
+
+
+        void
+        append_label_value(std::string& out,
+                           std::string_view value);
+
+
+        void
+        append_json_string(std::string& out,
+                           std::string_view value);
+
+
+        /*----------------------*/
+        /* Function definitions */
+        /*----------------------*/
+
+
+        // Extract the "host:port" part of an URL, without the user info.
+        std::string_view
+        host_of(std::string_view url)
+            noexcept
+        {
+            auto scheme_end = url.find("://");
+            if (scheme_end != std::string_view::npos)
+                url.remove_prefix(scheme_end + 3);
+            url = url.substr(0, url.find_first_of("/?#"));
+            auto at = url.rfind('@');
+            if (at != std::string_view::npos)
+                url.remove_prefix(at + 1);
+            return url;
+        }
+
+
+        // Times reported by libcurl are measured from the start, and can be zero for the
+        // phases that didn't happen; this avoids negative durations.
+        microseconds
+        elapsed(microseconds later,
+                microseconds earlier)
+            noexcept
+        {
+            return later > earlier ? later - earlier : microseconds{0};
+        }
+
+
+        // Leaves dest unchanged if the info is not available.
+        template<typename T,
+                 typename U>
+        void
+        getinfo_into(CURL* handle,
+                     CURLINFO info,
+                     U& dest)
+            noexcept
+        {
+            T result;
+            if (curl_easy_getinfo(handle, info, &result) == CURLE_OK)
+                dest = static_cast<U>(result);
+        }
+
+
+        void
+        append_uint(std::string& out,
+                    std::uint64_t value)
+        {
+            char buf[24];
+            auto [end, ec] = std::to_chars(buf, buf + sizeof buf, value);
+            out.append(buf, end);
+        }
+
+
+        void
+        append_seconds(std::string& out,
+                       microseconds value)
+        {
+            char buf[32];
+            auto [end, ec] = std::to_chars(buf, buf + sizeof buf, value.count() / 1e6);
+            out.append(buf, end);
+        }
+
+
+        void
+        append_label_value(std::string& out,
+                           std::string_view value)
+        {
+            out += '"';
+            for (char c : value) {
+                switch (c) {
+                    case '\\':
+                        out += "\\\\";
+                        break;
+                    case '"':
+                        out += "\\\"";
+                        break;
+                    case '\n':
+                        out += "\\n";
+                        break;
+                    default:
+                        out += c;
+                }
+            }
+            out += '"';
+        }
+
+
+        void
+        append_json_string(std::string& out,
+                           std::string_view value)
+        {
+            static constexpr char hex[] = "0123456789abcdef";
+            out += '"';
+            for (char c : value) {
+                auto u = static_cast<unsigned char>(c);
+                if (c == '"' || c == '\\') {
+                    out += '\\';
+                    out += c;
+                } else if (u < 0x20) {
+                    out += "\\u00";
+                    out += hex[u >> 4];
+                    out += hex[u & 0xf];
+                } else
+                    out += c;
+            }
+            out += '"';
+        }
+
+    } // namespace
+
+
+    /*-------------------*/
+    /* latency_histogram */
+    /*-------------------*/
+
+
+    microseconds
+    latency_histogram::snapshot::value_at_quantile(double q)
+        const noexcept
+    {
+        if (!count)
+            return microseconds{0};
+        q = std::clamp(q, 0.0, 1.0);
+        auto rank = std::max<std::uint64_t>(1, std::ceil(q * count));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < num_buckets; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                auto upper = static_cast<microseconds::rep>(bucket_range(i).second);
+                // The bucket's upper bound can overshoot the largest value recorded.
+                if (max.count() && max.count() < upper)
+                    return max;
+                return microseconds{upper};
+            }
+        }
+        return max;
+    }
+
+
+    std::uint64_t
+    latency_histogram::snapshot::count_at_most(microseconds limit)
+        const noexcept
+    {
+        std::uint64_t result = 0;
+        for (std::size_t i = 0; i < num_buckets; ++i) {
+            if (static_cast<microseconds::rep>(bucket_range(i).second) > limit.count())
+                break;
+            result += counts[i];
+        }
+        return result;
+    }
+
+
+    void
+    latency_histogram::record(microseconds value)
+        noexcept
+    {
+        std::uint64_t v = std::max<microseconds::rep>(value.count(), 0);
+        counts[bucket_index(v)].fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(v, std::memory_order_relaxed);
+        auto old_max = max.load(std::memory_order_relaxed);
+        while (old_max < v
+               && !max.compare_exchange_weak(old_max, v, std::memory_order_relaxed))
+            ;
+    }
+
+
+    latency_histogram::snapshot
+    latency_histogram::get_snapshot()
+        const noexcept
+    {
+        snapshot result;
+        for (std::size_t i = 0; i < num_buckets; ++i) {
+            result.counts[i] = counts[i].load(std::memory_order_relaxed);
+            result.count += result.counts[i];
+        }
+        result.sum = microseconds(sum.load(std::memory_order_relaxed));
+        result.max = microseconds(max.load(std::memory_order_relaxed));
+        return result;
+    }
+
+
+    void
+    latency_histogram::reset()
+        noexcept
+    {
+        for (auto& c : counts)
+            c.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+
+    std::size_t
+    latency_histogram::bucket_index(std::uint64_t value)
+        noexcept
+    {
+        value = std::min(value, (std::uint64_t{1} << max_value_bits) - 1);
+        if (value < sub_buckets)
+            return value;
+        // Keep the top sub_bucket_bits + 1 bits; the leading one selects the power of two.
+        unsigned shift = std::bit_width(value) - (sub_bucket_bits + 1);
+        return (shift + 1) * sub_buckets + (value >> shift) - sub_buckets;
+    }
+
+
+    std::pair<std::uint64_t, std::uint64_t>
+    latency_histogram::bucket_range(std::size_t index)
+        noexcept
+    {
+        if (index < sub_buckets)
+            return {index, index};
+        unsigned shift = index / sub_buckets - 1;
+        std::uint64_t mantissa = index % sub_buckets + sub_buckets;
+        return {mantissa << shift, ((mantissa + 1) << shift) - 1};
+    }
+
+
+    /*----------------*/
+    /* transfer_phase */
+    /*----------------*/
+
+
+    std::string_view
+    to_string(transfer_phase phase)
+        noexcept
+    {
+        switch (phase) {
+            case transfer_phase::queue:
+                return "queue";
+            case transfer_phase::name_lookup:
+                return "name_lookup";
+            case transfer_phase::connect:
+                return "connect";
+            case transfer_phase::tls:
+                return "tls";
+            case transfer_phase::server_wait:
+                return "server_wait";
+            case transfer_phase::body:
+                return "body";
+            case transfer_phase::total:
+                return "total";
+        }
+        return "unknown";
+    }
+
+
+    /*------------------*/
+    /* metrics_registry */
+    /*------------------*/
+
+
+    host_metrics*
+    metrics_registry::find_or_create(std::string_view host)
+        noexcept
+    {
+        {
+            std::shared_lock lock{mutex};
+            auto it = hosts.find(host);
+            if (it != hosts.end())
+                return it->second.get();
+        }
+        try {
+            auto metrics = std::make_unique<host_metrics>();
+            std::unique_lock lock{mutex};
+            // Another thread might have added it in the meantime.
+            auto [it, inserted] = hosts.emplace(std::string{host}, std::move(metrics));
+            return it->second.get();
+        }
+        catch (...) {
+            return nullptr;
+        }
+    }
+
+
+    void
+    metrics_registry::record(const easy& ez,
+                             CURLcode result)
+        noexcept
+    {
+        // This runs for every completion read by the multi handle, so only what the
+        // other record() uses is queried, instead of the full easy::get_transfer_stats().
+        CURL* handle = ez.data();
+        char* url = nullptr;
+        curl_easy_getinfo(handle, CURLINFO_EFFECTIVE_URL, &url);
+
+        easy::transfer_stats stats;
+        getinfo_into<curl_off_t>(handle, CURLINFO_SIZE_DOWNLOAD_T, stats.size_download);
+        getinfo_into<curl_off_t>(handle, CURLINFO_SIZE_UPLOAD_T, stats.size_upload);
+        getinfo_into<long>(handle, CURLINFO_NUM_CONNECTS, stats.num_connects);
+        getinfo_into<curl_off_t>(handle, CURLINFO_PRETRANSFER_TIME_T, stats.pre_transfer);
+        // Same rule as easy::get_transfer_stats().
+        stats.reused_connection = stats.num_connects == 0 && stats.pre_transfer.count() > 0;
+
+        // The phases are only recorded for successful transfers.
+        if (result == CURLE_OK) {
+#if CURL_AT_LEAST_VERSION(8, 6, 0)
+            getinfo_into<curl_off_t>(handle, CURLINFO_QUEUE_TIME_T, stats.queue);
+#endif
+            getinfo_into<curl_off_t>(handle, CURLINFO_TOTAL_TIME_T, stats.total);
+            getinfo_into<curl_off_t>(handle,
+                                     CURLINFO_STARTTRANSFER_TIME_T,
+                                     stats.start_transfer);
+            if (stats.num_connects > 0) {
+                getinfo_into<curl_off_t>(handle,
+                                         CURLINFO_NAMELOOKUP_TIME_T,
+                                         stats.name_lookup);
+                getinfo_into<curl_off_t>(handle, CURLINFO_CONNECT_TIME_T, stats.connect);
+                getinfo_into<curl_off_t>(handle,
+                                         CURLINFO_APPCONNECT_TIME_T,
+                                         stats.app_connect);
+            }
+        }
+
+        record(host_of(url ? url : ""), stats, result);
+    }
+
+
+    void
+    metrics_registry::record(std::string_view host,
+                             const easy::transfer_stats& stats,
+                             CURLcode result)
+        noexcept
+    {
+        auto m = find_or_create(host);
+        if (!m)
+            return;
+
+        constexpr auto relaxed = std::memory_order_relaxed;
+
+        m->transfers.fetch_add(1, relaxed);
+        if (result >= 0 && result < CURL_LAST)
+            m->results[result].fetch_add(1, relaxed);
+        if (stats.size_download > 0)
+            m->bytes_downloaded.fetch_add(stats.size_download, relaxed);
+        if (stats.size_upload > 0)
+            m->bytes_uploaded.fetch_add(stats.size_upload, relaxed);
+        if (stats.num_connects > 0)
+            m->new_connections.fetch_add(stats.num_connects, relaxed);
+        else if (stats.reused_connection)
+            m->reused_connections.fetch_add(1, relaxed);
+
+        if (result != CURLE_OK)
+            return;
+
+#if CURL_AT_LEAST_VERSION(8, 6, 0)
+        (*m)[transfer_phase::queue].record(stats.queue);
+#endif
+        if (stats.num_connects > 0) {
+            (*m)[transfer_phase::name_lookup].record(elapsed(stats.name_lookup, stats.queue));
+            (*m)[transfer_phase::connect].record(elapsed(stats.connect, stats.name_lookup));
+            // app_connect is zero when there was no TLS handshake (see
+            // easy::transfer_stats); there's no tls phase then.
+            if (stats.app_connect.count() > 0)
+                (*m)[transfer_phase::tls].record(elapsed(stats.app_connect, stats.connect));
+        }
+        (*m)[transfer_phase::server_wait].record(elapsed(stats.start_transfer,
+                                                         stats.pre_transfer));
+        (*m)[transfer_phase::body].record(elapsed(stats.total, stats.start_transfer));
+        (*m)[transfer_phase::total].record(stats.total);
+    }
+
+
+    std::vector<host_metrics_snapshot>
+    metrics_registry::get_snapshot()
+        const
+    {
+        constexpr auto relaxed = std::memory_order_relaxed;
+
+        std::vector<host_metrics_snapshot> result;
+        {
+            std::shared_lock lock{mutex};
+            result.reserve(hosts.size());
+            for (auto& [host, m] : hosts) {
+                auto& snap = result.emplace_back();
+                snap.host = host;
+                for (std::size_t i = 0; i < num_transfer_phases; ++i)
+                    snap.phases[i] = m->phases[i].get_snapshot();
+                snap.transfers          = m->transfers.load(relaxed);
+                snap.bytes_downloaded   = m->bytes_downloaded.load(relaxed);
+                snap.bytes_uploaded     = m->bytes_uploaded.load(relaxed);
+                snap.new_connections    = m->new_connections.load(relaxed);
+                snap.reused_connections = m->reused_connections.load(relaxed);
+                for (int code = CURLE_OK + 1; code < CURL_LAST; ++code)
+                    if (auto n = m->results[code].load(relaxed))
+                        snap.errors.emplace_back(static_cast<CURLcode>(code), n);
+            }
+        }
+        std::ranges::sort(result, {}, &host_metrics_snapshot::host);
+        return result;
+    }
+
+
+    void
+    metrics_registry::reset()
+        noexcept
+    {
+        constexpr auto relaxed = std::memory_order_relaxed;
+
+        // Only the counters change, so the shared lock is enough.
+        std::shared_lock lock{mutex};
+        for (auto& [host, m] : hosts) {
+            for (auto& h : m->phases)
+                h.reset();
+            m->transfers.store(0, relaxed);
+            m->bytes_downloaded.store(0, relaxed);
+            m->bytes_uploaded.store(0, relaxed);
+            m->new_connections.store(0, relaxed);
+            m->reused_connections.store(0, relaxed);
+            for (auto& r : m->results)
+                r.store(0, relaxed);
+        }
+    }
+
+
+    /*-----------*/
+    /* Exporters */
+    /*-----------*/
+
+
+    std::string
+    format_prometheus(std::span<const host_metrics_snapshot> snapshot,
+                      std::string_view prefix)
+    {
+        static constexpr microseconds bucket_limits[] = {
+            microseconds{100},
+            microseconds{250},
+            microseconds{500},
+            microseconds{1'000},
+            microseconds{2'500},
+            microseconds{5'000},
+            microseconds{10'000},
+            microseconds{25'000},
+            microseconds{50'000},
+            microseconds{100'000},
+            microseconds{250'000},
+            microseconds{500'000},
+            microseconds{1'000'000},
+            microseconds{2'500'000},
+            microseconds{5'000'000},
+            microseconds{10'000'000},
+            microseconds{30'000'000},
+            microseconds{60'000'000},
+        };
+
+        std::string out;
+
+        auto header = [&](std::string_view name,
+                          std::string_view type,
+                          std::string_view help)
+        {
+            out += "# HELP ";
+            out += prefix;
+            out += name;
+            out += ' ';
+            out += help;
+            out += "\n# TYPE ";
+            out += prefix;
+            out += name;
+            out += ' ';
+            out += type;
+            out += '\n';
+        };
+
+        // Writes the metric name and the host label, leaving the label set open.
+        auto sample = [&](std::string_view name,
+                          const host_metrics_snapshot& h)
+        {
+            out += prefix;
+            out += name;
+            out += "{host=";
+            append_label_value(out, h.host);
+        };
+
+        auto counter = [&](std::string_view name,
+                           std::string_view help,
+                           std::uint64_t host_metrics_snapshot::* member)
+        {
+            header(name, "counter", help);
+            for (auto& h : snapshot) {
+                sample(name, h);
+                out += "} ";
+                append_uint(out, h.*member);
+                out += '\n';
+            }
+        };
+
+        counter("_transfers_total",
+                "Completed transfers.",
+                &host_metrics_snapshot::transfers);
+        counter("_downloaded_bytes_total",
+                "Bytes downloaded.",
+                &host_metrics_snapshot::bytes_downloaded);
+        counter("_uploaded_bytes_total",
+                "Bytes uploaded.",
+                &host_metrics_snapshot::bytes_uploaded);
+        counter("_new_connections_total",
+                "New connections created.",
+                &host_metrics_snapshot::new_connections);
+        counter("_reused_connections_total",
+                "Transfers that reused an existing connection.",
+                &host_metrics_snapshot::reused_connections);
+
+        header("_errors_total", "counter", "Failed transfers, by CURLcode.");
+        for (auto& h : snapshot)
+            for (auto [code, n] : h.errors) {
+                sample("_errors_total", h);
+                out += ",code=\"";
+                append_uint(out, code);
+                out += "\"} ";
+                append_uint(out, n);
+                out += '\n';
+            }
+
+        header("_phase_duration_seconds",
+               "histogram",
+               "Duration of each phase of successful transfers.");
+        for (auto& h : snapshot)
+            for (std::size_t p = 0; p < num_transfer_phases; ++p) {
+                auto& hist = h.phases[p];
+                if (!hist.count)
+                    continue;
+                auto phase = to_string(static_cast<transfer_phase>(p));
+
+                auto phase_sample = [&](std::string_view suffix) {
+                    out += prefix;
+                    out += "_phase_duration_seconds";
+                    out += suffix;
+                    out += "{host=";
+                    append_label_value(out, h.host);
+                    out += ",phase=\"";
+                    out += phase;
+                    out += '"';
+                };
+
+                for (auto limit : bucket_limits) {
+                    phase_sample("_bucket");
+                    out += ",le=\"";
+                    append_seconds(out, limit);
+                    out += "\"} ";
+                    append_uint(out, hist.count_at_most(limit));
+                    out += '\n';
+                }
+                phase_sample("_bucket");
+                out += ",le=\"+Inf\"} ";
+                append_uint(out, hist.count);
+                out += '\n';
+
+                phase_sample("_sum");
+                out += "} ";
+                append_seconds(out, hist.sum);
+                out += '\n';
+
+                phase_sample("_count");
+                out += "} ";
+                append_uint(out, hist.count);
+                out += '\n';
+            }
+
+        return out;
+    }
+
+
+    std::string
+    format_json(std::span<const host_metrics_snapshot> snapshot)
+    {
+        static constexpr std::pair<std::string_view, double> quantiles[] = {
+            {"p50_us",  0.5},
+            {"p90_us",  0.9},
+            {"p99_us",  0.99},
+            {"p999_us", 0.999},
+        };
+
+        std::string out = "{\"hosts\":[";
+
+        auto field = [&](std::string_view name,
+                         std::uint64_t value)
+        {
+            out += '"';
+            out += name;
+            out += "\":";
+            append_uint(out, value);
+        };
+
+        for (std::size_t i = 0; i < snapshot.size(); ++i) {
+            auto& h = snapshot[i];
+            if (i)
+                out += ',';
+            out += "{\"host\":";
+            append_json_string(out, h.host);
+            out += ',';
+            field("transfers", h.transfers);
+            out += ',';
+            field("bytes_downloaded", h.bytes_downloaded);
+            out += ',';
+            field("bytes_uploaded", h.bytes_uploaded);
+            out += ',';
+            field("new_connections", h.new_connections);
+            out += ',';
+            field("reused_connections", h.reused_connections);
+
+            out += ",\"errors\":{";
+            for (std::size_t e = 0; e < h.errors.size(); ++e) {
+                if (e)
+                    out += ',';
+                out += '"';
+                append_uint(out, h.errors[e].first);
+                out += "\":";
+                append_uint(out, h.errors[e].second);
+            }
+
+            out += "},\"phases\":{";
+            for (std::size_t p = 0; p < num_transfer_phases; ++p) {
+                auto& hist = h.phases[p];
+                if (p)
+                    out += ',';
+                append_json_string(out, to_string(static_cast<transfer_phase>(p)));
+                out += ":{";
+                field("count", hist.count);
+                out += ',';
+                field("sum_us", hist.sum.count());
+                out += ',';
+                field("max_us", hist.max.count());
+                for (auto [name, q] : quantiles) {
+                    out += ',';
+                    field(name, hist.value_at_quantile(q).count());
+                }
+                out += '}';
+            }
+            out += "}}";
+        }
+
+        out += "]}";
+        return out;
+    }
+
+} // namespace curl
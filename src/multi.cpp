@@ -5,9 +5,13 @@
  * SPDX-License-Identifier: LGPL-3.0-or-later
  */
 
+#include <algorithm>
+#include <climits>
+
 #include "curlxx/multi.hpp"
 
 #include "curlxx/easy.hpp"
+#include "curlxx/metrics.hpp"
 #include "utils.hpp"
 
 
@@ -32,6 +36,15 @@ namespace curl {
                     T arg)
             noexcept;
 
+        void
+        wrap_unsetopt(CURLM* raw,
+                      CURLMoption opt)
+            noexcept;
+
+        int
+        to_timeout_ms(std::chrono::milliseconds timeout)
+            noexcept;
+
         /*----------------------*/
         /* Function definitions */
         /*----------------------*/
@@ -50,6 +63,24 @@ namespace curl {
             return {};
         }
 
+
+        void
+        wrap_unsetopt(CURLM* raw,
+                      CURLMoption opt)
+            noexcept
+        {
+            curl_multi_setopt(raw, opt, static_cast<void*>(nullptr));
+        }
+
+
+        // libcurl takes the timeout as an int; don't let a large one wrap around.
+        int
+        to_timeout_ms(std::chrono::milliseconds timeout)
+            noexcept
+        {
+            return std::clamp<std::chrono::milliseconds::rep>(timeout.count(), 0, INT_MAX);
+        }
+
     } // namespace
 
 
@@ -69,6 +100,25 @@ namespace curl {
     }
 
 
+    multi::multi(multi&& other)
+        noexcept
+    {
+        acquire(other.release());
+    }
+
+
+    multi&
+    multi::operator =(multi&& other)
+        noexcept
+    {
+        if (this != &other) {
+            destroy();
+            acquire(other.release());
+        }
+        return *this;
+    }
+
+
     multi::~multi()
         noexcept
     {
@@ -99,8 +149,45 @@ namespace curl {
     multi::destroy()
         noexcept
     {
-        if (is_valid())
-            curl_multi_cleanup(release());
+        if (is_valid()) {
+            auto [old_raw, old_state] = release();
+            // The pushed handles are destroyed after the multi handle, so detach them first.
+            for (auto& ez : old_state.pushed)
+                curl_multi_remove_handle(old_raw, ez->data());
+            curl_multi_cleanup(old_raw);
+        }
+    }
+
+
+    multi::state_type
+    multi::release()
+        noexcept
+    {
+        state_type result{
+            base_type::release(),
+            std::move(extra_state)
+        };
+        extra_state = {};
+        return result;
+    }
+
+
+    void
+    multi::acquire(state_type new_state)
+        noexcept
+    {
+        base_type::acquire(get<0>(new_state));
+        extra_state = std::move(get<1>(new_state));
+        setup_extra_state();
+    }
+
+
+    void
+    multi::acquire(raw_type new_raw)
+        noexcept
+    {
+        base_type::acquire(new_raw);
+        setup_extra_state();
     }
 
 
@@ -118,6 +205,7 @@ namespace curl {
         auto e = curl_multi_add_handle(raw, ez.data());
         if (e)
             return unexpected{error{e}};
+        ez.start_transfer();
         return {};
     }
 
@@ -159,19 +247,187 @@ namespace curl {
     }
 
 
+    unsigned
+    multi::socket_action(curl_socket_t s,
+                         int ev_bitmask)
+    {
+        return value_or_throw(try_socket_action(s, ev_bitmask));
+    }
+
+
+    expected<unsigned, error>
+    multi::try_socket_action(curl_socket_t s,
+                             int ev_bitmask)
+        noexcept
+    {
+        int running_handles = 0;
+        auto e = curl_multi_socket_action(raw, s, ev_bitmask, &running_handles);
+        if (e)
+            return unexpected{error{e}};
+        return running_handles;
+    }
+
+
+    unsigned
+    multi::poll(std::chrono::milliseconds timeout,
+                std::span<curl_waitfd> extra_fds)
+    {
+        return value_or_throw(try_poll(timeout, extra_fds));
+    }
+
+
+    expected<unsigned, error>
+    multi::try_poll(std::chrono::milliseconds timeout,
+                    std::span<curl_waitfd> extra_fds)
+        noexcept
+    {
+        int num_fds = 0;
+        auto e = curl_multi_poll(raw,
+                                 extra_fds.data(),
+                                 extra_fds.size(),
+                                 to_timeout_ms(timeout),
+                                 &num_fds);
+        if (e)
+            return unexpected{error{e}};
+        return num_fds;
+    }
+
+
+    unsigned
+    multi::wait(std::chrono::milliseconds timeout,
+                std::span<curl_waitfd> extra_fds)
+    {
+        return value_or_throw(try_wait(timeout, extra_fds));
+    }
+
+
+    expected<unsigned, error>
+    multi::try_wait(std::chrono::milliseconds timeout,
+                    std::span<curl_waitfd> extra_fds)
+        noexcept
+    {
+        int num_fds = 0;
+        auto e = curl_multi_wait(raw,
+                                 extra_fds.data(),
+                                 extra_fds.size(),
+                                 to_timeout_ms(timeout),
+                                 &num_fds);
+        if (e)
+            return unexpected{error{e}};
+        return num_fds;
+    }
+
+
+    void
+    multi::wakeup()
+    {
+        return value_or_throw(try_wakeup());
+    }
+
+
+    expected<void, error>
+    multi::try_wakeup()
+        noexcept
+    {
+        auto e = curl_multi_wakeup(raw);
+        if (e)
+            return unexpected{error{e}};
+        return {};
+    }
+
+
+    void
+    multi::assign(curl_socket_t s,
+                  void* socket_data)
+    {
+        return value_or_throw(try_assign(s, socket_data));
+    }
+
+
+    expected<void, error>
+    multi::try_assign(curl_socket_t s,
+                      void* socket_data)
+        noexcept
+    {
+        auto e = curl_multi_assign(raw, s, socket_data);
+        if (e)
+            return unexpected{error{e}};
+        return {};
+    }
+
+
+    std::chrono::milliseconds
+    multi::get_timeout()
+    {
+        return value_or_throw(try_get_timeout());
+    }
+
+
+    expected<std::chrono::milliseconds, error>
+    multi::try_get_timeout()
+        noexcept
+    {
+        long timeout_ms = -1;
+        auto e = curl_multi_timeout(raw, &timeout_ms);
+        if (e)
+            return unexpected{error{e}};
+        return std::chrono::milliseconds{timeout_ms};
+    }
+
+
     std::vector<multi::msg_done>
     multi::get_done()
     {
         std::vector<msg_done> result;
+        get_done(result);
+        return result;
+    }
+
+
+    void
+    multi::get_done(std::vector<msg_done>& result)
+    {
+        result.clear();
+        while (auto msg = next_done())
+            result.push_back(*msg);
+    }
+
+
+    std::optional<multi::msg_done>
+    multi::next_done()
+        noexcept
+    {
         int pending;
         while (auto msg = curl_multi_info_read(raw, &pending)) {
             // ignore unknown messages
             if (msg->msg != CURLMSG_DONE)
                 continue;
-            result.emplace_back(easy::get_wrapper(msg->easy_handle),
-                                msg->data.result);
+            msg_done result{easy::get_wrapper(msg->easy_handle),
+                            msg->data.result};
+            if (result.handle) {
+                if (extra_state.metrics)
+                    extra_state.metrics->record(*result.handle, result.result);
+                result.handle->finish_transfer(result.result);
+            }
+            return result;
         }
-        return result;
+        return {};
+    }
+
+
+    void
+    multi::set_metrics(std::shared_ptr<metrics_registry> registry)
+        noexcept
+    {
+        extra_state.metrics = std::move(registry);
+    }
+
+
+    const std::shared_ptr<metrics_registry>&
+    multi::get_metrics()
+        const noexcept
+    {
+        return extra_state.metrics;
     }
 
 
@@ -254,6 +510,83 @@ namespace curl {
 #endif // CURL_AT_LEAST_VERSION(8, 16, 0)
 
 
+#if CURL_AT_LEAST_VERSION(8, 17, 0)
+
+    void
+    multi::set_notify_function(notify_function_t notify_func)
+    {
+        return value_or_throw(try_set_notify_function(std::move(notify_func)));
+    }
+
+
+    std::expected<void, error>
+    multi::try_set_notify_function(notify_function_t notify_func)
+        noexcept
+    {
+        if (!notify_func) {
+            unset_notify_function();
+            return {};
+        }
+
+        auto data_status = wrap_setopt(raw, CURLMOPT_NOTIFYDATA, this);
+        if (!data_status)
+            return data_status;
+        auto func_status = wrap_setopt(raw, CURLMOPT_NOTIFYFUNCTION, &notify_callback_helper);
+        if (!func_status)
+            return func_status;
+        extra_state.notify_func = std::move(notify_func);
+        return {};
+    }
+
+
+    void
+    multi::unset_notify_function()
+        noexcept
+    {
+        extra_state.notify_func = {};
+        wrap_unsetopt(raw, CURLMOPT_NOTIFYDATA);
+        wrap_unsetopt(raw, CURLMOPT_NOTIFYFUNCTION);
+    }
+
+
+    void
+    multi::enable_notification(unsigned notification)
+    {
+        return value_or_throw(try_enable_notification(notification));
+    }
+
+
+    std::expected<void, error>
+    multi::try_enable_notification(unsigned notification)
+        noexcept
+    {
+        auto e = curl_multi_notify_enable(raw, notification);
+        if (e)
+            return unexpected{error{e}};
+        return {};
+    }
+
+
+    void
+    multi::disable_notification(unsigned notification)
+    {
+        return value_or_throw(try_disable_notification(notification));
+    }
+
+
+    std::expected<void, error>
+    multi::try_disable_notification(unsigned notification)
+        noexcept
+    {
+        auto e = curl_multi_notify_disable(raw, notification);
+        if (e)
+            return unexpected{error{e}};
+        return {};
+    }
+
+#endif // CURL_AT_LEAST_VERSION(8, 17, 0)
+
+
     void
     multi::set_pipelining(long mask)
     {
@@ -268,4 +601,313 @@ namespace curl {
         return wrap_setopt(raw, CURLMOPT_PIPELINING, mask);
     }
 
+
+    void
+    multi::set_push_function(push_function_t push_func)
+    {
+        return value_or_throw(try_set_push_function(std::move(push_func)));
+    }
+
+
+    std::expected<void, error>
+    multi::try_set_push_function(push_function_t push_func)
+        noexcept
+    {
+        if (!push_func) {
+            unset_push_function();
+            return {};
+        }
+
+        auto data_status = wrap_setopt(raw, CURLMOPT_PUSHDATA, this);
+        if (!data_status)
+            return data_status;
+        auto func_status = wrap_setopt(raw, CURLMOPT_PUSHFUNCTION, &push_callback_helper);
+        if (!func_status)
+            return func_status;
+        extra_state.push_func = std::move(push_func);
+        return {};
+    }
+
+
+    void
+    multi::unset_push_function()
+        noexcept
+    {
+        extra_state.push_func = {};
+        wrap_unsetopt(raw, CURLMOPT_PUSHDATA);
+        wrap_unsetopt(raw, CURLMOPT_PUSHFUNCTION);
+    }
+
+
+    void
+    multi::set_socket_function(socket_function_t socket_func)
+    {
+        return value_or_throw(try_set_socket_function(std::move(socket_func)));
+    }
+
+
+    std::expected<void, error>
+    multi::try_set_socket_function(socket_function_t socket_func)
+        noexcept
+    {
+        if (!socket_func) {
+            unset_socket_function();
+            return {};
+        }
+
+        auto data_status = wrap_setopt(raw, CURLMOPT_SOCKETDATA, this);
+        if (!data_status)
+            return data_status;
+        auto func_status = wrap_setopt(raw, CURLMOPT_SOCKETFUNCTION, &socket_callback_helper);
+        if (!func_status)
+            return func_status;
+        extra_state.socket_func = std::move(socket_func);
+        return {};
+    }
+
+
+    void
+    multi::unset_socket_function()
+        noexcept
+    {
+        extra_state.socket_func = {};
+        wrap_unsetopt(raw, CURLMOPT_SOCKETDATA);
+        wrap_unsetopt(raw, CURLMOPT_SOCKETFUNCTION);
+    }
+
+
+    void
+    multi::set_timer_function(timer_function_t timer_func)
+    {
+        return value_or_throw(try_set_timer_function(std::move(timer_func)));
+    }
+
+
+    std::expected<void, error>
+    multi::try_set_timer_function(timer_function_t timer_func)
+        noexcept
+    {
+        if (!timer_func) {
+            unset_timer_function();
+            return {};
+        }
+
+        auto data_status = wrap_setopt(raw, CURLMOPT_TIMERDATA, this);
+        if (!data_status)
+            return data_status;
+        auto func_status = wrap_setopt(raw, CURLMOPT_TIMERFUNCTION, &timer_callback_helper);
+        if (!func_status)
+            return func_status;
+        extra_state.timer_func = std::move(timer_func);
+        return {};
+    }
+
+
+    void
+    multi::unset_timer_function()
+        noexcept
+    {
+        extra_state.timer_func = {};
+        wrap_unsetopt(raw, CURLMOPT_TIMERDATA);
+        wrap_unsetopt(raw, CURLMOPT_TIMERFUNCTION);
+    }
+
+
+    easy
+    multi::take_pushed(easy& ez)
+    {
+        return value_or_throw(try_take_pushed(ez));
+    }
+
+
+    std::expected<easy, error>
+    multi::try_take_pushed(easy& ez)
+        noexcept
+    {
+        auto& pushed = extra_state.pushed;
+        auto it = std::ranges::find(pushed,
+                                    &ez,
+                                    [](const std::unique_ptr<easy>& p) { return p.get(); });
+        if (it == pushed.end())
+            return unexpected{error{CURLM_BAD_EASY_HANDLE}};
+        auto e = curl_multi_remove_handle(raw, ez.data());
+        if (e)
+            return unexpected{error{e}};
+        easy result = std::move(**it);
+        pushed.erase(it);
+        return result;
+    }
+
+
+    multi::push_headers::push_headers(curl_pushheaders* raw,
+                                      std::size_t count)
+        noexcept :
+        raw{raw},
+        count{count}
+    {}
+
+
+    std::size_t
+    multi::push_headers::size()
+        const noexcept
+    {
+        return count;
+    }
+
+
+    std::string_view
+    multi::push_headers::operator [](std::size_t index)
+        const noexcept
+    {
+        const char* str = curl_pushheader_bynum(raw, index);
+        return str ? str : "";
+    }
+
+
+    std::optional<std::string_view>
+    multi::push_headers::find(const char* name)
+        const noexcept
+    {
+        const char* str = curl_pushheader_byname(raw, name);
+        if (!str)
+            return {};
+        return str;
+    }
+
+
+    void
+    multi::setup_extra_state()
+        noexcept
+    {
+        if (raw) {
+            // The callbacks receive this wrapper as their data pointer, so it must follow
+            // the wrapper when it moves.
+#if CURL_AT_LEAST_VERSION(8, 17, 0)
+            if (extra_state.notify_func)
+                curl_multi_setopt(raw, CURLMOPT_NOTIFYDATA, this);
+#endif
+            if (extra_state.push_func)
+                curl_multi_setopt(raw, CURLMOPT_PUSHDATA, this);
+            if (extra_state.socket_func)
+                curl_multi_setopt(raw, CURLMOPT_SOCKETDATA, this);
+            if (extra_state.timer_func)
+                curl_multi_setopt(raw, CURLMOPT_TIMERDATA, this);
+        } else {
+            extra_state = {};
+        }
+    }
+
+
+#if CURL_AT_LEAST_VERSION(8, 17, 0)
+
+    void
+    multi::notify_callback_helper(CURLM*,
+                                  unsigned notification,
+                                  CURL* target,
+                                  multi* m)
+        noexcept
+    {
+        try {
+            if (m && m->extra_state.notify_func)
+                m->extra_state.notify_func(notification,
+                                           target ? easy::get_wrapper(target) : nullptr);
+        }
+        catch (...) {
+        }
+    }
+
+#endif // CURL_AT_LEAST_VERSION(8, 17, 0)
+
+
+    int
+    multi::push_callback_helper(CURL* parent,
+                                CURL* pushed,
+                                std::size_t num_headers,
+                                curl_pushheaders* headers,
+                                multi* m)
+        noexcept
+    {
+        if (!m || !m->extra_state.push_func)
+            return CURL_PUSH_DENY;
+
+        try {
+            // Make room first, so nothing can fail after accepting. Grow geometrically:
+            // reserve() allocates exactly what's asked for.
+            auto& pushed_list = m->extra_state.pushed;
+            if (pushed_list.size() == pushed_list.capacity())
+                pushed_list.reserve(std::max<std::size_t>(8, 2 * pushed_list.capacity()));
+
+            auto ez = std::make_unique<easy>(nullptr);
+            easy* parent_ez = easy::get_wrapper(parent);
+            ez->adopt_duplicate(pushed, parent_ez);
+
+            bool accept = false;
+            // The duplicated write function was unset, and libcurl's default one writes to
+            // stdout; collect the body in memory instead, unless the push function picks
+            // another target.
+            if (ez->extra_state.memory_body.enabled || ez->try_set_write_to_memory()) {
+                try {
+                    accept = m->extra_state.push_func(parent_ez,
+                                                      *ez,
+                                                      push_headers{headers, num_headers});
+                }
+                catch (...) {
+                }
+            }
+
+            if (!accept) {
+                // libcurl destroys denied handles.
+                std::ignore = ez->release();
+                return CURL_PUSH_DENY;
+            }
+
+            pushed_list.push_back(std::move(ez));
+            return CURL_PUSH_OK;
+        }
+        catch (...) {
+            return CURL_PUSH_DENY;
+        }
+    }
+
+
+    int
+    multi::socket_callback_helper(CURL* handle,
+                                  curl_socket_t s,
+                                  int what,
+                                  multi* m,
+                                  void* socket_data)
+        noexcept
+    {
+        try {
+            if (m && m->extra_state.socket_func)
+                return m->extra_state.socket_func(easy::get_wrapper(handle),
+                                                  s,
+                                                  what,
+                                                  socket_data);
+            else
+                return 0;
+        }
+        catch (...) {
+            return -1;
+        }
+    }
+
+
+    int
+    multi::timer_callback_helper(CURLM*,
+                                 long timeout_ms,
+                                 multi* m)
+        noexcept
+    {
+        try {
+            if (m && m->extra_state.timer_func)
+                return m->extra_state.timer_func(std::chrono::milliseconds{timeout_ms});
+            else
+                return 0;
+        }
+        catch (...) {
+            return -1;
+        }
+    }
+
 } // namespace curl
@@ -0,0 +1,234 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <stop_token>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#include "curlxx/multi_pool.hpp"
+
+
+using namespace std::literals;
+
+
+namespace curl {
+
+    struct multi_pool::shard {
+
+        multi_pool* owner;
+        std::size_t index;
+
+        multi multi_handle;
+        detail::mpsc_queue<easy> inbox;
+        std::unordered_map<easy*, std::unique_ptr<easy>> active;
+
+        std::atomic<std::uint64_t> submitted = 0;
+        std::atomic<std::uint64_t> completed = 0;
+        std::atomic<std::uint64_t> failed = 0;
+        std::atomic<std::uint64_t> wakeups = 0;
+        std::atomic<unsigned> running = 0;
+
+        // Note: declared last, so the thread is joined before anything else is destroyed.
+        std::jthread worker;
+
+
+        shard(multi_pool* owner,
+              std::size_t index) :
+            owner{owner},
+            index{index}
+        {}
+
+
+        void
+        start()
+        {
+            worker = std::jthread{[this](std::stop_token token) { run(token); }};
+        }
+
+
+        void
+        stop()
+            noexcept
+        {
+            worker.request_stop();
+            std::ignore = multi_handle.try_wakeup();
+        }
+
+
+        void
+        add_pending()
+        {
+            while (auto ez = inbox.pop()) {
+                auto ptr = std::make_unique<easy>(std::move(*ez));
+                auto status = multi_handle.try_add(*ptr);
+                if (!status) {
+                    ++completed;
+                    ++failed;
+                    owner->push_completion({std::move(*ptr), CURLE_FAILED_INIT, index});
+                    continue;
+                }
+                easy* key = ptr.get();
+                active.emplace(key, std::move(ptr));
+            }
+        }
+
+
+        void
+        collect_done()
+        {
+            multi_handle.visit_done([this](const multi::msg_done& msg)
+            {
+                auto it = active.find(msg.handle);
+                if (it == active.end())
+                    return;
+                std::ignore = multi_handle.try_remove(*msg.handle);
+                auto ptr = std::move(it->second);
+                active.erase(it);
+                ++completed;
+                if (msg.result != CURLE_OK)
+                    ++failed;
+                owner->push_completion({std::move(*ptr), msg.result, index});
+            });
+        }
+
+
+        void
+        run(std::stop_token token)
+        {
+            while (!token.stop_requested()) {
+                add_pending();
+                std::ignore = multi_handle.try_perform();
+                collect_done();
+                running.store(active.size(), std::memory_order_relaxed);
+                // Either libcurl has work, or a submission/stop request wakes us up.
+                std::ignore = multi_handle.try_poll(1000ms);
+                ++wakeups;
+            }
+
+            for (auto& [ez, ptr] : active)
+                std::ignore = multi_handle.try_remove(*ez);
+            active.clear();
+            running.store(0, std::memory_order_relaxed);
+        }
+
+    }; // struct multi_pool::shard
+
+
+    multi_pool::multi_pool(std::size_t num_shards,
+                           setup_function_t setup)
+    {
+        if (!num_shards)
+            num_shards = std::max(1u, std::thread::hardware_concurrency());
+
+        shards.reserve(num_shards);
+        for (std::size_t i = 0; i < num_shards; ++i) {
+            shards.push_back(std::make_unique<shard>(this, i));
+            if (setup)
+                setup(shards.back()->multi_handle);
+        }
+
+        for (auto& s : shards)
+            s->start();
+    }
+
+
+    multi_pool::~multi_pool()
+        noexcept
+    {
+        for (auto& s : shards)
+            s->stop();
+        shards.clear();
+    }
+
+
+    void
+    multi_pool::push_completion(completion c)
+    {
+        completions.push(std::move(c));
+        completions_pushed.fetch_add(1, std::memory_order_release);
+        completions_pushed.notify_one();
+    }
+
+
+    std::size_t
+    multi_pool::submit(easy ez)
+    {
+        return submit(std::move(ez), next_shard.fetch_add(1, std::memory_order_relaxed));
+    }
+
+
+    std::size_t
+    multi_pool::submit(easy ez,
+                       std::size_t key)
+    {
+        std::size_t index = key % shards.size();
+        shard& s = *shards[index];
+        ++s.submitted;
+        s.inbox.push(std::move(ez));
+        s.multi_handle.wakeup();
+        return index;
+    }
+
+
+    std::optional<multi_pool::completion>
+    multi_pool::try_pop()
+    {
+        return completions.pop();
+    }
+
+
+    multi_pool::completion
+    multi_pool::pop()
+    {
+        for (;;) {
+            auto seen = completions_pushed.load(std::memory_order_acquire);
+            if (auto c = completions.pop())
+                return std::move(*c);
+            completions_pushed.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+
+    std::size_t
+    multi_pool::size()
+        const noexcept
+    {
+        return shards.size();
+    }
+
+
+    multi_pool::shard_stats
+    multi_pool::get_stats(std::size_t index)
+        const noexcept
+    {
+        const shard& s = *shards[index];
+        return {
+            .submitted = s.submitted.load(std::memory_order_relaxed),
+            .completed = s.completed.load(std::memory_order_relaxed),
+            .failed    = s.failed.load(std::memory_order_relaxed),
+            .wakeups   = s.wakeups.load(std::memory_order_relaxed),
+            .running   = s.running.load(std::memory_order_relaxed),
+        };
+    }
+
+
+    std::vector<multi_pool::shard_stats>
+    multi_pool::get_stats()
+        const
+    {
+        std::vector<shard_stats> result;
+        result.reserve(shards.size());
+        for (std::size_t i = 0; i < shards.size(); ++i)
+            result.push_back(get_stats(i));
+        return result;
+    }
+
+} // namespace curl
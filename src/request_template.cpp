@@ -0,0 +1,43 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include <utility>
+
+#include "curlxx/request_template.hpp"
+
+
+namespace curl {
+
+    request_template::request_template() = default;
+
+
+    request_template::request_template(easy prototype) :
+        prototype{std::move(prototype)}
+    {}
+
+
+    easy
+    request_template::make()
+        const
+    {
+        std::lock_guard guard{mutex};
+        return easy{prototype};
+    }
+
+
+    easy
+    request_template::make(const std::string& url_str)
+        const
+    {
+        easy result = make();
+        // A URL object would take precedence over the URL string.
+        result.unset_url();
+        result.set_url(url_str);
+        return result;
+    }
+
+} // namespace curl
@@ -0,0 +1,325 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include <new>
+#include <utility>
+
+#include "curlxx/share.hpp"
+
+#include "utils.hpp"
+
+
+using std::expected;
+using std::unexpected;
+
+using curl::utils::value_or_throw;
+
+
+namespace curl {
+
+    namespace {
+
+        /*-----------------------*/
+        /* Function declarations */
+        /*-----------------------*/
+
+        template<typename T>
+        std::expected<void, error>
+        wrap_setopt(CURLSH* raw,
+                    CURLSHoption opt,
+                    T arg)
+            noexcept;
+
+        /*----------------------*/
+        /* Function definitions */
+        /*----------------------*/
+
+
+        template<typename T>
+        std::expected<void, error>
+        wrap_setopt(CURLSH* raw,
+                    CURLSHoption opt,
+                    T arg)
+            noexcept
+        {
+            auto e = curl_share_setopt(raw, opt, arg);
+            if (e)
+                return std::unexpected{error{e}};
+            return {};
+        }
+
+    } // namespace
+
+
+    /*------------------*/
+    /* Public functions */
+    /*------------------*/
+
+    share::share()
+    {
+        create();
+    }
+
+
+    // Delegating, so the destructor cleans up the handle if set_locking() throws.
+    share::share(locking mode) :
+        share{}
+    {
+        set_locking(mode);
+    }
+
+
+    share::share(CURLSH* handle)
+    {
+        create(handle);
+    }
+
+
+    share::share(share&& other)
+        noexcept
+    {
+        acquire(other.release());
+    }
+
+
+    share&
+    share::operator =(share&& other)
+        noexcept
+    {
+        if (this != &other) {
+            destroy();
+            acquire(other.release());
+        }
+        return *this;
+    }
+
+
+    share::~share()
+        noexcept
+    {
+        destroy();
+    }
+
+
+    void
+    share::create()
+    {
+        auto new_raw = curl_share_init();
+        if (!new_raw)
+            throw error{"curl_share_init() failed"};
+        destroy();
+        acquire(new_raw);
+    }
+
+
+    void
+    share::create(CURLSH* handle)
+    {
+        destroy();
+        acquire(handle);
+    }
+
+
+    void
+    share::destroy()
+        noexcept
+    {
+        if (is_valid()) {
+            auto [old_raw, old_locks] = release();
+            curl_share_cleanup(old_raw);
+        }
+    }
+
+
+    share::state_type
+    share::release()
+        noexcept
+    {
+        return state_type{
+            base_type::release(),
+            std::move(locks)
+        };
+    }
+
+
+    void
+    share::acquire(state_type new_state)
+        noexcept
+    {
+        base_type::acquire(get<0>(new_state));
+        locks = std::move(get<1>(new_state));
+    }
+
+
+    void
+    share::acquire(raw_type new_raw)
+        noexcept
+    {
+        base_type::acquire(new_raw);
+        locks.reset();
+    }
+
+
+    void
+    share::set_locking(locking mode)
+    {
+        return value_or_throw(try_set_locking(mode));
+    }
+
+
+    std::expected<void, error>
+    share::try_set_locking(locking mode)
+        noexcept
+    {
+        std::unique_ptr<lock_table> new_locks;
+        if (mode != locking::none) {
+            new_locks.reset(new (std::nothrow) lock_table);
+            if (!new_locks)
+                return unexpected{error{CURLSHE_NOMEM}};
+            new_locks->mode = mode;
+        }
+
+        auto status = try_install_locks(new_locks.get());
+        if (!status) {
+            // Don't leave libcurl with a mix of old and new settings, or pointing to
+            // new_locks after it's gone; the old settings were accepted before.
+            (void) try_install_locks(locks.get());
+            return status;
+        }
+
+        locks = std::move(new_locks);
+        return {};
+    }
+
+
+    void
+    share::set_share(data_type d)
+    {
+        return value_or_throw(try_set_share(d));
+    }
+
+
+    std::expected<void, error>
+    share::try_set_share(data_type d)
+        noexcept
+    {
+        return wrap_setopt(raw, CURLSHOPT_SHARE, static_cast<curl_lock_data>(d));
+    }
+
+
+    void
+    share::set_unshare(data_type d)
+    {
+        return value_or_throw(try_set_unshare(d));
+    }
+
+
+    std::expected<void, error>
+    share::try_set_unshare(data_type d)
+        noexcept
+    {
+        return wrap_setopt(raw, CURLSHOPT_UNSHARE, static_cast<curl_lock_data>(d));
+    }
+
+
+    std::expected<void, error>
+    share::try_install_locks(lock_table* table)
+        noexcept
+    {
+        auto data_status = wrap_setopt(raw, CURLSHOPT_USERDATA, table);
+        if (!data_status)
+            return data_status;
+
+        auto mode = table ? table->mode : locking::none;
+        std::expected<void, error> lock_status;
+        std::expected<void, error> unlock_status;
+        switch (mode) {
+            case locking::none:
+                lock_status = wrap_setopt(raw,
+                                          CURLSHOPT_LOCKFUNC,
+                                          static_cast<curl_lock_function>(nullptr));
+                unlock_status = wrap_setopt(raw,
+                                            CURLSHOPT_UNLOCKFUNC,
+                                            static_cast<curl_unlock_function>(nullptr));
+                break;
+            case locking::mutex:
+                lock_status = wrap_setopt(raw, CURLSHOPT_LOCKFUNC, &mutex_lock_helper);
+                unlock_status = wrap_setopt(raw, CURLSHOPT_UNLOCKFUNC, &mutex_unlock_helper);
+                break;
+            case locking::shared_mutex:
+                lock_status = wrap_setopt(raw,
+                                          CURLSHOPT_LOCKFUNC,
+                                          &shared_mutex_lock_helper);
+                unlock_status = wrap_setopt(raw,
+                                            CURLSHOPT_UNLOCKFUNC,
+                                            &shared_mutex_unlock_helper);
+                break;
+        }
+        if (!lock_status)
+            return lock_status;
+        return unlock_status;
+    }
+
+
+    void
+    share::mutex_lock_helper(CURL*,
+                             curl_lock_data d,
+                             curl_lock_access,
+                             lock_table* table)
+        noexcept
+    {
+        if (table && d < CURL_LOCK_DATA_LAST)
+            table->mutexes[d].lock();
+    }
+
+
+    void
+    share::mutex_unlock_helper(CURL*,
+                               curl_lock_data d,
+                               lock_table* table)
+        noexcept
+    {
+        if (table && d < CURL_LOCK_DATA_LAST)
+            table->mutexes[d].unlock();
+    }
+
+
+    void
+    share::shared_mutex_lock_helper(CURL*,
+                                    curl_lock_data d,
+                                    curl_lock_access access,
+                                    lock_table* table)
+        noexcept
+    {
+        if (!table || d >= CURL_LOCK_DATA_LAST)
+            return;
+        if (access == CURL_LOCK_ACCESS_SHARED)
+            table->shared_mutexes[d].lock_shared();
+        else {
+            table->shared_mutexes[d].lock();
+            table->writers[d].store(std::this_thread::get_id(), std::memory_order_relaxed);
+        }
+    }
+
+
+    void
+    share::shared_mutex_unlock_helper(CURL*,
+                                      curl_lock_data d,
+                                      lock_table* table)
+        noexcept
+    {
+        if (!table || d >= CURL_LOCK_DATA_LAST)
+            return;
+        // Only the thread holding the exclusive lock can find its own id here.
+        if (table->writers[d].load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+            table->writers[d].store(std::thread::id{}, std::memory_order_relaxed);
+            table->shared_mutexes[d].unlock();
+        } else
+            table->shared_mutexes[d].unlock_shared();
+    }
+
+} // namespace curl
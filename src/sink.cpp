@@ -0,0 +1,149 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include <cerrno>
+#include <cstring>
+
+#include <unistd.h>
+
+#include "curlxx/sink.hpp"
+
+
+namespace curl {
+
+    /*-----------*/
+    /* span_sink */
+    /*-----------*/
+
+    span_sink::span_sink(std::span<std::byte> dest)
+        noexcept :
+        dest{dest}
+    {}
+
+
+    std::size_t
+    span_sink::write(std::span<const char> data)
+        noexcept
+    {
+        std::size_t available = dest.size() - written;
+        std::size_t amount = data.size();
+        if (amount > available) {
+            amount = available;
+            overflowed = true;
+        }
+        if (amount)
+            std::memcpy(dest.data() + written, data.data(), amount);
+        written += amount;
+        return amount;
+    }
+
+
+    void
+    span_sink::rewind()
+        noexcept
+    {
+        written = 0;
+        overflowed = false;
+    }
+
+
+    std::span<std::byte>
+    span_sink::get_data()
+        const noexcept
+    {
+        return dest.first(written);
+    }
+
+
+    std::size_t
+    span_sink::get_written()
+        const noexcept
+    {
+        return written;
+    }
+
+
+    bool
+    span_sink::is_overflowed()
+        const noexcept
+    {
+        return overflowed;
+    }
+
+
+    /*---------*/
+    /* fd_sink */
+    /*---------*/
+
+    fd_sink::fd_sink(int fd)
+        noexcept :
+        fd{fd},
+        offset{0},
+        positional{false}
+    {}
+
+
+    fd_sink::fd_sink(int fd,
+                     std::int64_t offset)
+        noexcept :
+        fd{fd},
+        offset{offset},
+        positional{true}
+    {}
+
+
+    std::size_t
+    fd_sink::write(std::span<const char> data)
+        noexcept
+    {
+        std::size_t done = 0;
+        while (done < data.size()) {
+            ::ssize_t r;
+            if (positional)
+                r = ::pwrite(fd, data.data() + done, data.size() - done, offset);
+            else
+                r = ::write(fd, data.data() + done, data.size() - done);
+            if (r < 0) {
+                if (errno == EINTR)
+                    continue;
+                last_error = std::error_code{errno, std::system_category()};
+                break;
+            }
+            if (r == 0)
+                break;
+            done += r;
+            if (positional)
+                offset += r;
+        }
+        return done;
+    }
+
+
+    int
+    fd_sink::get_fd()
+        const noexcept
+    {
+        return fd;
+    }
+
+
+    std::int64_t
+    fd_sink::get_offset()
+        const noexcept
+    {
+        return offset;
+    }
+
+
+    std::error_code
+    fd_sink::get_error()
+        const noexcept
+    {
+        return last_error;
+    }
+
+} // namespace curl
@@ -0,0 +1,367 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "curlxx/source.hpp"
+
+
+namespace curl {
+
+    namespace {
+
+        [[noreturn]]
+        void
+        throw_errno(const char* what)
+        {
+            throw std::system_error{errno, std::generic_category(), what};
+        }
+
+
+        // Apply fseek()-style arguments, return the new position if it's valid.
+        std::optional<std::int64_t>
+        resolve_seek(std::int64_t current,
+                     std::int64_t size,
+                     curl_off_t offset,
+                     int origin)
+            noexcept
+        {
+            std::int64_t result;
+            switch (origin) {
+                case SEEK_SET:
+                    result = offset;
+                    break;
+                case SEEK_CUR:
+                    result = current + offset;
+                    break;
+                case SEEK_END:
+                    result = size + offset;
+                    break;
+                default:
+                    return {};
+            }
+            if (result < 0 || result > size)
+                return {};
+            return result;
+        }
+
+    } // namespace
+
+
+    /*---------------*/
+    /* memory_source */
+    /*---------------*/
+
+    memory_source::memory_source(std::span<const std::byte> data)
+        noexcept :
+        data{data}
+    {}
+
+
+    memory_source::memory_source(std::string_view data)
+        noexcept :
+        data{std::as_bytes(std::span{data})}
+    {}
+
+
+    std::size_t
+    memory_source::read(std::span<char> buffer)
+        noexcept
+    {
+        std::size_t amount = std::min(buffer.size(), data.size() - position);
+        if (amount)
+            std::memcpy(buffer.data(), data.data() + position, amount);
+        position += amount;
+        return amount;
+    }
+
+
+    int
+    memory_source::seek(curl_off_t offset,
+                        int origin)
+        noexcept
+    {
+        auto new_pos = resolve_seek(position, data.size(), offset, origin);
+        if (!new_pos)
+            return CURL_SEEKFUNC_FAIL;
+        position = *new_pos;
+        return CURL_SEEKFUNC_OK;
+    }
+
+
+    curl_off_t
+    memory_source::size()
+        const noexcept
+    {
+        return data.size();
+    }
+
+
+    /*-------------*/
+    /* mmap_source */
+    /*-------------*/
+
+    mmap_source::mmap_source(const std::filesystem::path& filename)
+    {
+        int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw_errno("open()");
+        try {
+            map(fd);
+        }
+        catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+    }
+
+
+    mmap_source::mmap_source(int fd)
+    {
+        map(fd);
+    }
+
+
+    mmap_source::mmap_source(mmap_source&& other)
+        noexcept :
+        data{std::exchange(other.data, nullptr)},
+        length{std::exchange(other.length, 0)},
+        position{std::exchange(other.position, 0)}
+    {}
+
+
+    mmap_source::~mmap_source()
+        noexcept
+    {
+        unmap();
+    }
+
+
+    mmap_source&
+    mmap_source::operator =(mmap_source&& other)
+        noexcept
+    {
+        if (this != &other) {
+            unmap();
+            data = std::exchange(other.data, nullptr);
+            length = std::exchange(other.length, 0);
+            position = std::exchange(other.position, 0);
+        }
+        return *this;
+    }
+
+
+    void
+    mmap_source::map(int fd)
+    {
+        struct ::stat st;
+        if (::fstat(fd, &st) < 0)
+            throw_errno("fstat()");
+        length = st.st_size;
+        // Can't map an empty file, but there's nothing to upload anyway.
+        if (!length)
+            return;
+        void* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+            throw_errno("mmap()");
+        // It's only a hint, failure is not a problem.
+        ::madvise(addr, length, MADV_SEQUENTIAL);
+        data = static_cast<const std::byte*>(addr);
+    }
+
+
+    void
+    mmap_source::unmap()
+        noexcept
+    {
+        if (data)
+            ::munmap(const_cast<std::byte*>(data), length);
+        data = nullptr;
+        length = 0;
+        position = 0;
+    }
+
+
+    std::size_t
+    mmap_source::read(std::span<char> buffer)
+        noexcept
+    {
+        std::size_t amount = std::min(buffer.size(), length - position);
+        if (amount)
+            std::memcpy(buffer.data(), data + position, amount);
+        position += amount;
+        return amount;
+    }
+
+
+    int
+    mmap_source::seek(curl_off_t offset,
+                      int origin)
+        noexcept
+    {
+        auto new_pos = resolve_seek(position, length, offset, origin);
+        if (!new_pos)
+            return CURL_SEEKFUNC_FAIL;
+        position = *new_pos;
+        return CURL_SEEKFUNC_OK;
+    }
+
+
+    curl_off_t
+    mmap_source::size()
+        const noexcept
+    {
+        return length;
+    }
+
+
+    /*-----------*/
+    /* fd_source */
+    /*-----------*/
+
+    fd_source::fd_source(int fd,
+                         std::int64_t offset,
+                         std::int64_t length) :
+        fd{fd},
+        start{offset},
+        length{length}
+    {
+        if (this->length < 0) {
+            struct ::stat st;
+            if (::fstat(fd, &st) < 0)
+                throw_errno("fstat()");
+            this->length = std::max<std::int64_t>(st.st_size - start, 0);
+        }
+    }
+
+
+    std::size_t
+    fd_source::read(std::span<char> buffer)
+        noexcept
+    {
+        std::size_t wanted = std::min<std::int64_t>(buffer.size(), length - position);
+        std::size_t done = 0;
+        while (done < wanted) {
+            ::ssize_t r = ::pread(fd,
+                                  buffer.data() + done,
+                                  wanted - done,
+                                  start + position);
+            if (r < 0) {
+                if (errno == EINTR)
+                    continue;
+                // Don't report a short body as the end.
+                if (!done)
+                    return CURL_READFUNC_ABORT;
+                break;
+            }
+            if (r == 0)
+                break;
+            done += r;
+            position += r;
+        }
+        return done;
+    }
+
+
+    int
+    fd_source::seek(curl_off_t offset,
+                    int origin)
+        noexcept
+    {
+        auto new_pos = resolve_seek(position, length, offset, origin);
+        if (!new_pos)
+            return CURL_SEEKFUNC_FAIL;
+        position = *new_pos;
+        return CURL_SEEKFUNC_OK;
+    }
+
+
+    curl_off_t
+    fd_source::size()
+        const noexcept
+    {
+        return length;
+    }
+
+
+    /*---------------*/
+    /* gather_source */
+    /*---------------*/
+
+    gather_source::gather_source(std::span<const std::span<const std::byte>> segments)
+        noexcept :
+        segments{segments}
+    {
+        for (auto& seg : segments)
+            total += seg.size();
+    }
+
+
+    std::size_t
+    gather_source::read(std::span<char> buffer)
+        noexcept
+    {
+        std::size_t done = 0;
+        while (done < buffer.size() && segment < segments.size()) {
+            auto seg = segments[segment];
+            std::size_t amount = std::min(buffer.size() - done, seg.size() - inner);
+            if (amount)
+                std::memcpy(buffer.data() + done, seg.data() + inner, amount);
+            done += amount;
+            inner += amount;
+            if (inner == seg.size()) {
+                ++segment;
+                inner = 0;
+            }
+        }
+        position += done;
+        return done;
+    }
+
+
+    int
+    gather_source::seek(curl_off_t offset,
+                        int origin)
+        noexcept
+    {
+        auto new_pos = resolve_seek(position, total, offset, origin);
+        if (!new_pos)
+            return CURL_SEEKFUNC_FAIL;
+
+        position = *new_pos;
+        segment = 0;
+        inner = 0;
+        std::size_t remaining = position;
+        while (segment < segments.size() && remaining >= segments[segment].size()) {
+            remaining -= segments[segment].size();
+            ++segment;
+        }
+        inner = remaining;
+        return CURL_SEEKFUNC_OK;
+    }
+
+
+    curl_off_t
+    gather_source::size()
+        const noexcept
+    {
+        return total;
+    }
+
+} // namespace curl
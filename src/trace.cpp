@@ -0,0 +1,348 @@
+/*
+ * curlxx - A C++ wrapper for libcurl.
+ * Copyright 2026  Daniel K. O. (dkosmari)
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "curlxx/trace.hpp"
+
+#include "curlxx/error.hpp"
+
+
+namespace curl {
+
+    namespace {
+
+        constexpr char dump_magic[8] = {'c', 'u', 'r', 'l', 'x', 'x', 't', 'r'};
+        constexpr std::uint32_t dump_version = 1;
+        constexpr std::size_t dump_header_size = 24;
+        constexpr std::size_t dump_record_size = 24;
+
+
+        // Identifies each tracer in the thread-local caches; never reused.
+        std::atomic<std::uint64_t> tracer_counter = 0;
+
+
+        /*-----------------------*/
+        /* Function declarations */
+        /*-----------------------*/
+
+        template<typename T>
+        void
+        put_le(std::byte*& dst,
+               T value)
+            noexcept;
+
+        template<typename T>
+        T
+        get_le(const std::byte*& src)
+            noexcept;
+
+
+        /*----------------------*/
+        /* Function definitions */
+        /*----------------------*/
+
+
+        template<typename T>
+        void
+        put_le(std::byte*& dst,
+               T value)
+            noexcept
+        {
+            for (std::size_t i = 0; i < sizeof(T); ++i)
+                *dst++ = static_cast<std::byte>(value >> (8 * i));
+        }
+
+
+        template<typename T>
+        T
+        get_le(const std::byte*& src)
+            noexcept
+        {
+            T value = 0;
+            for (std::size_t i = 0; i < sizeof(T); ++i)
+                value |= static_cast<T>(std::to_integer<std::uint8_t>(*src++)) << (8 * i);
+            return value;
+        }
+
+    } // namespace
+
+
+    std::string_view
+    to_string(trace_event event)
+        noexcept
+    {
+        switch (event) {
+            case trace_event::resolve_start:
+                return "resolve_start";
+            case trace_event::connect_start:
+                return "connect_start";
+            case trace_event::connected:
+                return "connected";
+            case trace_event::connection_reused:
+                return "connection_reused";
+            case trace_event::tls_done:
+                return "tls_done";
+            case trace_event::header_out:
+                return "header_out";
+            case trace_event::header_in:
+                return "header_in";
+            case trace_event::first_byte:
+                return "first_byte";
+            case trace_event::done:
+                return "done";
+        }
+        return "unknown";
+    }
+
+
+    // Each record takes 3 words: time, transfer, and the packed arg, thread and event.
+    // The writer announces the slot it's about to overwrite in `reserved`, before writing
+    // it, and makes it visible in `published` after; a reader can then tell which of the
+    // records it copied might have been overwritten in the meantime.
+    struct tracer::ring {
+
+        std::unique_ptr<std::atomic<std::uint64_t>[]> words;
+        std::size_t mask;
+        std::uint16_t thread;
+        std::atomic<std::uint64_t> reserved = 0;
+        std::atomic<std::uint64_t> published = 0;
+
+
+        ring(std::size_t capacity,
+             std::uint16_t thread) :
+            words{std::make_unique<std::atomic<std::uint64_t>[]>(3 * capacity)},
+            mask{capacity - 1},
+            thread{thread}
+        {}
+
+    }; // struct tracer::ring
+
+
+    tracer::tracer(std::size_t capacity,
+                   unsigned sample_period) :
+        id{tracer_counter.fetch_add(1, std::memory_order_relaxed) + 1},
+        capacity{std::bit_ceil(std::max<std::size_t>(capacity, 2))},
+        sample_period{sample_period}
+    {}
+
+
+    tracer::~tracer()
+        noexcept = default;
+
+
+    void
+    tracer::set_sample_period(unsigned period)
+        noexcept
+    {
+        sample_period.store(period, std::memory_order_relaxed);
+    }
+
+
+    unsigned
+    tracer::get_sample_period()
+        const noexcept
+    {
+        return sample_period.load(std::memory_order_relaxed);
+    }
+
+
+    std::uint64_t
+    tracer::start_transfer()
+        noexcept
+    {
+        unsigned period = sample_period.load(std::memory_order_relaxed);
+        if (!period)
+            return 0;
+        auto n = transfer_counter.fetch_add(1, std::memory_order_relaxed);
+        if (n % period)
+            return 0;
+        return n + 1;
+    }
+
+
+    tracer::ring*
+    tracer::get_ring()
+    {
+        // A small cache, so a thread finds its ring without locking; the tracer ids are
+        // never reused, so entries from destroyed tracers are never matched.
+        thread_local std::array<std::pair<std::uint64_t, ring*>, 4> cache{};
+        thread_local std::size_t cache_next = 0;
+
+        for (auto [owner, r] : cache)
+            if (owner == id)
+                return r;
+
+        // On a cache miss, the ring might still exist: the entry could have been evicted
+        // by other tracers.
+        ring* r;
+        {
+            std::lock_guard lock{mutex};
+            auto& slot = thread_rings[std::this_thread::get_id()];
+            if (!slot) {
+                auto thread = static_cast<std::uint16_t>(rings.size());
+                rings.reserve(rings.size() + 1);
+                slot = rings.emplace_back(std::make_unique<ring>(capacity, thread)).get();
+            }
+            r = slot;
+        }
+        cache[cache_next++ % cache.size()] = {id, r};
+        return r;
+    }
+
+
+    void
+    tracer::record(std::uint64_t transfer,
+                   trace_event event,
+                   std::uint32_t arg)
+        noexcept
+    {
+        if (!transfer)
+            return;
+        record(std::chrono::steady_clock::now(), transfer, event, arg);
+    }
+
+
+    void
+    tracer::record(std::chrono::steady_clock::time_point time,
+                   std::uint64_t transfer,
+                   trace_event event,
+                   std::uint32_t arg)
+        noexcept
+    {
+        if (!transfer)
+            return;
+
+        ring* r;
+        try {
+            r = get_ring();
+        }
+        catch (...) {
+            return;
+        }
+
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch());
+        std::uint64_t packed = arg
+            | std::uint64_t{r->thread} << 32
+            | std::uint64_t{static_cast<std::uint8_t>(event)} << 48;
+
+        // Only this thread writes to this ring.
+        auto index = r->published.load(std::memory_order_relaxed);
+        r->reserved.store(index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        auto* slot = &r->words[3 * (index & r->mask)];
+        slot[0].store(ns.count(), std::memory_order_relaxed);
+        slot[1].store(transfer, std::memory_order_relaxed);
+        slot[2].store(packed, std::memory_order_relaxed);
+
+        r->published.store(index + 1, std::memory_order_release);
+    }
+
+
+    std::vector<trace_record>
+    tracer::collect()
+        const
+    {
+        std::vector<trace_record> result;
+        std::vector<std::pair<std::uint64_t, trace_record>> copied;
+
+        std::lock_guard lock{mutex};
+        for (auto& r : rings) {
+            auto end = r->published.load(std::memory_order_acquire);
+            auto begin = end > capacity ? end - capacity : 0;
+
+            copied.clear();
+            for (auto index = begin; index < end; ++index) {
+                auto* slot = &r->words[3 * (index & r->mask)];
+                auto packed = slot[2].load(std::memory_order_relaxed);
+                trace_record rec;
+                rec.time = std::chrono::nanoseconds(slot[0].load(std::memory_order_relaxed));
+                rec.transfer = slot[1].load(std::memory_order_relaxed);
+                rec.arg = static_cast<std::uint32_t>(packed);
+                rec.thread = static_cast<std::uint16_t>(packed >> 32);
+                rec.event = static_cast<trace_event>(packed >> 48);
+                copied.emplace_back(index, rec);
+            }
+
+            // Drop what the writer might have overwritten while it was being copied.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            auto reserved = r->reserved.load(std::memory_order_relaxed);
+            auto first_valid = reserved > capacity ? reserved - capacity : 0;
+            for (auto& [index, rec] : copied)
+                if (index >= first_valid)
+                    result.push_back(rec);
+        }
+
+        std::ranges::stable_sort(result, {}, &trace_record::time);
+        return result;
+    }
+
+
+    std::vector<std::byte>
+    write_trace_dump(std::span<const trace_record> records)
+    {
+        std::vector<std::byte> result(dump_header_size + records.size() * dump_record_size);
+        std::byte* dst = result.data();
+
+        std::memcpy(dst, dump_magic, sizeof dump_magic);
+        dst += sizeof dump_magic;
+        put_le<std::uint32_t>(dst, dump_version);
+        put_le<std::uint32_t>(dst, dump_record_size);
+        put_le<std::uint64_t>(dst, records.size());
+
+        for (auto& rec : records) {
+            put_le<std::uint64_t>(dst, rec.time.count());
+            put_le<std::uint64_t>(dst, rec.transfer);
+            put_le<std::uint32_t>(dst, rec.arg);
+            put_le<std::uint16_t>(dst, rec.thread);
+            put_le<std::uint8_t>(dst, static_cast<std::uint8_t>(rec.event));
+            put_le<std::uint8_t>(dst, 0);
+        }
+
+        return result;
+    }
+
+
+    std::vector<trace_record>
+    read_trace_dump(std::span<const std::byte> dump)
+    {
+        if (dump.size() < dump_header_size
+            || std::memcmp(dump.data(), dump_magic, sizeof dump_magic))
+            throw error{"invalid trace dump"};
+
+        const std::byte* src = dump.data() + sizeof dump_magic;
+        auto version = get_le<std::uint32_t>(src);
+        auto record_size = get_le<std::uint32_t>(src);
+        auto count = get_le<std::uint64_t>(src);
+        if (version != dump_version || record_size < dump_record_size)
+            throw error{"unsupported trace dump version"};
+        if (count > (dump.size() - dump_header_size) / record_size)
+            throw error{"truncated trace dump"};
+
+        std::vector<trace_record> result;
+        result.reserve(count);
+        for (std::uint64_t i = 0; i < count; ++i) {
+            const std::byte* next = src + record_size;
+            trace_record rec;
+            rec.time = std::chrono::nanoseconds(get_le<std::uint64_t>(src));
+            rec.transfer = get_le<std::uint64_t>(src);
+            rec.arg = get_le<std::uint32_t>(src);
+            rec.thread = get_le<std::uint16_t>(src);
+            rec.event = static_cast<trace_event>(get_le<std::uint8_t>(src));
+            result.push_back(rec);
+            src = next;
+        }
+        return result;
+    }
+
+} // namespace curl